@@ -2,6 +2,7 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <malloc.h>
 #include <memory>
@@ -11,6 +12,7 @@
 #include <variant>
 #include <vector>
 
+#include <poly/bucketed_vector.h>
 #include <poly/vector.h>
 
 using namespace poly;
@@ -25,6 +27,8 @@ struct Interface {
 
     virtual std::string toString() const = 0;
 
+    virtual int key() const = 0;
+
     virtual ~Interface() = default;
 };
 
@@ -42,6 +46,8 @@ public:
         return std::string("Implementation1(") + std::to_string(_current) + ")";
     }
 
+    int key() const override { return _current; }
+
 private:
     int _current;
 };
@@ -60,10 +66,34 @@ public:
         return std::string("Implementation2(") + std::to_string(_op1) + ")";
     }
 
+    int key() const override { return static_cast<int>(_op1); }
+
 private:
     double _op1;
 };
 
+class alignas(cache_line_size) Statistics : public Interface {
+public:
+    Statistics(unsigned samples)
+        : _samples { samples }
+        , _sum {}
+    {
+    }
+
+    void doYourThing() override { _sum += _samples; }
+
+    std::string toString() const override
+    {
+        return std::string("Statistics(") + std::to_string(_sum) + ")";
+    }
+
+    int key() const override { return static_cast<int>(_samples); }
+
+private:
+    unsigned _samples;
+    double   _sum;
+};
+
 using namespace std::chrono;
 
 template <typename T> T getArgv(int argc, char* argv[], int idx)
@@ -368,6 +398,208 @@ struct AllocCount : public BenchmarkBase<AllocCount> {
     }
 };
 
+struct MixedAlignment : public BenchmarkBase<MixedAlignment> {
+    using natural_vector = vector<Interface, std::allocator<Interface>,
+        delegate_cloning_policy<Interface>, vector_layout<pointer_index, natural_packing>>;
+
+    vector<Interface> pv;
+    natural_vector    nv;
+
+    MixedAlignment(int argc, char* argv[])
+        : BenchmarkBase(argc, argv)
+    {
+        // small events with a cache line aligned statistics object every now and then, the same
+        // sequence in both vectors
+        for (auto i = 0U; i < num_objs; ++i) {
+            if (i % 16 == 0) {
+                pv.push_back(Statistics(i));
+                nv.push_back(Statistics(i));
+            } else if (std::rand() % 2) {
+                const auto seed = std::rand();
+                pv.push_back(Implementation1(seed));
+                nv.push_back(Implementation1(seed));
+            } else {
+                pv.push_back(Implementation2(1.1, 1.3));
+                nv.push_back(Implementation2(1.1, 1.3));
+            }
+        }
+    }
+    template <typename V> static size_t bytes_per_elem(const V& v)
+    {
+        return sizeof(typename V::elem_ptr) + v.sizes().second;
+    }
+    std::chrono::microseconds run() override
+    {
+        std::cout << "max align packing: " << bytes_per_elem(pv) << " bytes/elem\n";
+        std::cout << "natural packing: " << bytes_per_elem(nv) << " bytes/elem\n";
+        const auto max_align
+            = timed<std::chrono::microseconds>(&BenchmarkBase::run_poly_vec)(*this);
+        std::cout << "poly_vec(max align packing): " << max_align.second.count() << " us\n";
+        auto res = timed<std::chrono::microseconds>([this] {
+            for (auto c = 0U; c < iteration_count; c++) {
+                std::for_each(nv.begin(), nv.end(), [](Interface& i) { i.doYourThing(); });
+            }
+        })();
+        std::cout << "poly_vec(natural packing): " << res.second.count() << " us\n";
+        return res.second;
+    }
+};
+
+struct Reallocation : public BenchmarkBase<Reallocation> {
+    Reallocation(int argc, char* argv[])
+        : BenchmarkBase(argc, argv)
+    {
+    }
+    std::chrono::microseconds run() override
+    {
+        std::chrono::microseconds total {};
+        // reallocation cost for growing sizes, each measured on a full vector
+        for (auto n = 1024U; n <= num_objs; n *= 2) {
+            std::chrono::microseconds elapsed {};
+            for (auto c = 0U; c < iteration_count; c++) {
+                vector<Interface> v;
+                v.reserve(n, sizeof(Implementation2));
+                for (auto i = 0U; i < n; ++i) {
+                    if (i % 2) {
+                        v.push_back(Implementation1(std::rand()));
+                    } else {
+                        v.push_back(Implementation2(1.1, 1.3));
+                    }
+                }
+                elapsed += timed<std::chrono::microseconds>(
+                    [&v] { v.reserve(v.capacity() * 2, sizeof(Implementation2)); })()
+                               .second;
+            }
+            std::cout << "reallocation of " << n << " elems: " << elapsed.count() / iteration_count
+                      << " us\n";
+            total += elapsed;
+        }
+        return total;
+    }
+};
+
+struct Bucketed : public BenchmarkBase<Bucketed> {
+    vector<Interface>          pv;
+    bucketed_vector<Interface> bv;
+
+    Bucketed(int argc, char* argv[])
+        : BenchmarkBase(argc, argv)
+    {
+        // the same randomly interleaved objects in both containers
+        for (auto i = 0U; i < num_objs; ++i) {
+            if (std::rand() % 2) {
+                pv.emplace_back<Implementation1>(std::rand());
+                bv.emplace_back<Implementation1>(std::rand());
+            } else {
+                pv.emplace_back<Implementation2>(1.1, 1.3);
+                bv.emplace_back<Implementation2>(1.1, 1.3);
+            }
+        }
+    }
+    std::chrono::microseconds run() override
+    {
+        auto interleaved = timed<std::chrono::microseconds>(&BenchmarkBase::run_poly_vec)(*this);
+        std::cout << "poly_vec: " << interleaved.second.count() << " us\n";
+        auto bucketed = timed<std::chrono::microseconds>([this] {
+            for (auto c = 0U; c < iteration_count; c++) {
+                bv.for_each([](Interface& i) { i.doYourThing(); });
+            }
+        })();
+        std::cout << "bucketed_vec(for_each): " << bucketed.second.count() << " us\n";
+        auto typed = timed<std::chrono::microseconds>([this] {
+            for (auto c = 0U; c < iteration_count; c++) {
+                // the qualified call is not virtual, so it can be inlined
+                bv.for_each_as<Implementation1, Implementation2>([](auto& i) {
+                    using T = std::decay_t<decltype(i)>;
+                    if constexpr (std::is_same_v<T, Interface>) {
+                        i.doYourThing();
+                    } else {
+                        i.T::doYourThing();
+                    }
+                });
+            }
+        })();
+        std::cout << "bucketed_vec(for_each_as): " << typed.second.count() << " us\n";
+        return typed.second;
+    }
+};
+
+struct Sorting : public BenchmarkBase<Sorting> {
+    vector<Interface>                       pv;
+    std::vector<std::unique_ptr<Interface>> sv;
+
+    Sorting(int argc, char* argv[])
+        : BenchmarkBase(argc, argv)
+    {
+        // the same randomly keyed objects in both containers
+        for (auto i = 0U; i < num_objs; ++i) {
+            const auto key = std::rand() % 65536;
+            if (i % 16 == 0) {
+                pv.push_back(Statistics(key));
+                sv.push_back(std::make_unique<Statistics>(key));
+            } else if (std::rand() % 2) {
+                pv.push_back(Implementation1(key));
+                sv.push_back(std::make_unique<Implementation1>(key));
+            } else {
+                pv.push_back(Implementation2(key, 1.3));
+                sv.push_back(std::make_unique<Implementation2>(key, 1.3));
+            }
+        }
+    }
+    std::chrono::microseconds run() override
+    {
+        const auto by_key = [](const Interface& lhs, const Interface& rhs) {
+            return lhs.key() < rhs.key();
+        };
+        auto sorted = timed<std::chrono::microseconds>([&] {
+            std::sort(sv.begin(), sv.end(), [&](const auto& lhs, const auto& rhs) {
+                return by_key(*lhs, *rhs);
+            });
+        })();
+        std::cout << "vector(sort): " << sorted.second.count() << " us\n";
+        auto res = timed<std::chrono::microseconds>(&BenchmarkBase::run_std_vec)(*this);
+        std::cout << "vector: " << res.second.count() << " us\n";
+
+        sorted = timed<std::chrono::microseconds>([&] { pv.sort(by_key); })();
+        std::cout << "poly_vec(sort): " << sorted.second.count() << " us\n";
+        res = timed<std::chrono::microseconds>(&BenchmarkBase::run_poly_vec)(*this);
+        std::cout << "poly_vec(index order): " << res.second.count() << " us\n";
+        sorted = timed<std::chrono::microseconds>([this] { pv.relayout(); })();
+        std::cout << "poly_vec(relayout): " << sorted.second.count() << " us\n";
+        res = timed<std::chrono::microseconds>(&BenchmarkBase::run_poly_vec)(*this);
+        std::cout << "poly_vec(address order): " << res.second.count() << " us\n";
+        return res.second;
+    }
+};
+
+struct Grouping : public BenchmarkBase<Grouping> {
+    vector<Interface> pv;
+
+    Grouping(int argc, char* argv[])
+        : BenchmarkBase(argc, argv)
+    {
+        // randomly interleaved types, as in BestCase
+        pv.reserve(num_objs, sizeof(Implementation2));
+        for (auto i = 0U; i < num_objs; ++i) {
+            if (std::rand() % 2) {
+                pv.push_back(Implementation1(std::rand()));
+            } else {
+                pv.push_back(Implementation2(1.1, 1.3));
+            }
+        }
+    }
+    std::chrono::microseconds run() override
+    {
+        auto res = timed<std::chrono::microseconds>(&BenchmarkBase::run_poly_vec)(*this);
+        std::cout << "poly_vec(interleaved): " << res.second.count() << " us\n";
+        const auto grouping = timed<std::chrono::microseconds>([this] { pv.group_by_type(); })();
+        std::cout << "poly_vec(group_by_type): " << grouping.second.count() << " us\n";
+        res = timed<std::chrono::microseconds>(&BenchmarkBase::run_poly_vec)(*this);
+        std::cout << "poly_vec(grouped): " << res.second.count() << " us\n";
+        return res.second;
+    }
+};
+
 std::unique_ptr<Benchmark> get_measurement(const std::string_view& name, int argc, char* argv[])
 {
     if (name == "WorstCase")
@@ -376,6 +608,16 @@ std::unique_ptr<Benchmark> get_measurement(const std::string_view& name, int arg
         return std::make_unique<AllocCount>(argc, argv);
     else if (name == "BestCase")
         return std::make_unique<BestCase>(argc, argv);
+    else if (name == "MixedAlignment")
+        return std::make_unique<MixedAlignment>(argc, argv);
+    else if (name == "Reallocation")
+        return std::make_unique<Reallocation>(argc, argv);
+    else if (name == "Bucketed")
+        return std::make_unique<Bucketed>(argc, argv);
+    else if (name == "Sorting")
+        return std::make_unique<Sorting>(argc, argv);
+    else if (name == "Grouping")
+        return std::make_unique<Grouping>(argc, argv);
     throw std::runtime_error(std::string("Invalid name:") + std::string(name));
 }
 
@@ -0,0 +1,308 @@
+// Copyright (c) 2016 Ferenc Nandor Janky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#pragma once
+
+#include <poly/vector.h>
+
+#include <algorithm>
+#include <typeindex>
+#include <vector>
+
+namespace poly {
+
+namespace vector_impl {
+    /// key of the bucket of a type: the type id of the cloning policy if it has one, the same
+    /// one vector::visit compares, the type_index of the type otherwise
+    template <class Policy, bool HasTypeId = has_type_id<Policy>::value> struct bucket_key {
+        using type = decltype(std::declval<const Policy&>().type_id());
+        template <class T> static type of() noexcept
+        {
+            return Policy::template type_id_of<T>();
+        }
+    };
+    template <class Policy> struct bucket_key<Policy, false> {
+        using type = std::type_index;
+        template <class T> static type of() noexcept { return typeid(T); }
+    };
+} // namespace vector_impl
+
+/// Polymorphic container keeping the objects of every concrete type in a bucket of their own,
+/// so processing them runs one tight loop per type instead of branching on the dynamic type of
+/// every element. The order of the objects is only kept among objects of the same type.
+/// Inserting looks the bucket of the type up among the buckets, consecutive insertions of the
+/// same type hit a cached bucket; every object costs an index entry of its bucket besides its
+/// storage.
+template <class IF, class Allocator = std::allocator<IF>,
+    class CloningPolicy = delegate_cloning_policy<IF, Allocator>>
+class bucketed_vector {
+public:
+    ///////////////////////////////////////////////
+    // Member types
+    ///////////////////////////////////////////////
+    /// the objects of a bucket have the same type, so each of them is placed at its own alignment
+    using bucket_type
+        = vector<IF, Allocator, CloningPolicy, vector_layout<pointer_index, natural_packing>>;
+    using interface_type            = typename bucket_type::interface_type;
+    using allocator_type            = typename bucket_type::allocator_type;
+    using interface_reference       = typename bucket_type::interface_reference;
+    using const_interface_reference = typename bucket_type::const_interface_reference;
+    using size_type                 = std::size_t;
+    ///////////////////////////////////////////////
+    // Ctors,Dtors & assignment
+    ///////////////////////////////////////////////
+    bucketed_vector() = default;
+    explicit bucketed_vector(const allocator_type& alloc);
+    ///////////////////////////////////////////////
+    // Modifiers
+    ///////////////////////////////////////////////
+    template <typename T>
+    std::enable_if_t<std::is_base_of<interface_type, std::decay_t<T>>::value, void> push_back(
+        T&& obj);
+
+    template <typename T, typename... Args>
+    std::enable_if_t<std::is_base_of<interface_type, T>::value, interface_reference> emplace_back(
+        Args&&... args);
+
+    /// reserves for n objects of type T in its bucket
+    template <typename T> void reserve(size_type n);
+    void clear() noexcept;
+    void swap(bucketed_vector& x) noexcept;
+    ///////////////////////////////////////////////
+    // Capacity
+    ///////////////////////////////////////////////
+    size_type size() const noexcept;
+    bool      empty() const noexcept;
+    /// number of distinct types stored so far
+    size_type buckets() const noexcept;
+    /// number of objects of type T
+    template <typename T> size_type count() const noexcept;
+    ///////////////////////////////////////////////
+    // Processing
+    ///////////////////////////////////////////////
+    /// calls f with every object, bucket by bucket
+    template <class F> void for_each(F&& f);
+    template <class F> void for_each(F&& f) const;
+    /// calls f with the objects of the listed types as their concrete type, and with the
+    /// interface for the objects of any other type; qualified calls or final types let the
+    /// compiler inline the calls made by f
+    template <typename... Ts, class F> void for_each_as(F&& f);
+    template <typename... Ts, class F> void for_each_as(F&& f) const;
+    ////////////////////////////
+    // Misc.
+    ////////////////////////////
+    allocator_type get_allocator() const noexcept;
+
+private:
+    using key_type = typename vector_impl::bucket_key<CloningPolicy>::type;
+    struct bucket {
+        key_type    key;
+        bucket_type objects;
+    };
+    using bucket_allocator_type =
+        typename std::allocator_traits<allocator_type>::template rebind_alloc<bucket>;
+
+    template <typename T> bucket_type&       bucket_of();
+    template <typename T> const bucket_type* find_bucket() const noexcept;
+
+    template <class Bucket, class F> static void visit_bucket(Bucket& b, F& f);
+    template <class Bucket, class F, typename T, typename... Ts>
+    static void visit_bucket(Bucket& b, F& f, type_tag<T> /*unused*/, type_tag<Ts>... ts);
+
+    std::vector<bucket, bucket_allocator_type> _buckets;
+    /// position of the bucket found last, checked first by the next lookup
+    size_type _last = 0;
+};
+
+template <class I, class A, class C>
+inline bucketed_vector<I, A, C>::bucketed_vector(const allocator_type& alloc)
+    : _buckets(bucket_allocator_type(alloc))
+{
+}
+
+template <class I, class A, class C>
+template <typename T>
+inline auto bucketed_vector<I, A, C>::push_back(T&& obj)
+    -> std::enable_if_t<std::is_base_of<interface_type, std::decay_t<T>>::value>
+{
+    bucket_of<std::decay_t<T>>().push_back(std::forward<T>(obj));
+}
+
+template <class I, class A, class C>
+template <typename T, typename... Args>
+inline auto bucketed_vector<I, A, C>::emplace_back(Args&&... args)
+    -> std::enable_if_t<std::is_base_of<interface_type, T>::value, interface_reference>
+{
+    return bucket_of<T>().template emplace_back<T>(std::forward<Args>(args)...);
+}
+
+template <class I, class A, class C>
+template <typename T>
+inline void bucketed_vector<I, A, C>::reserve(size_type n)
+{
+    bucket_of<T>().reserve(n, sizeof(T), alignof(T));
+}
+
+template <class I, class A, class C> inline void bucketed_vector<I, A, C>::clear() noexcept
+{
+    for (auto& b : _buckets) {
+        b.objects.clear();
+    }
+}
+
+template <class I, class A, class C>
+inline void bucketed_vector<I, A, C>::swap(bucketed_vector& x) noexcept
+{
+    _buckets.swap(x._buckets);
+    std::swap(_last, x._last);
+}
+
+template <class I, class A, class C>
+inline auto bucketed_vector<I, A, C>::size() const noexcept -> size_type
+{
+    size_type n = 0;
+    for (const auto& b : _buckets) {
+        n += b.objects.size();
+    }
+    return n;
+}
+
+template <class I, class A, class C> inline bool bucketed_vector<I, A, C>::empty() const noexcept
+{
+    return size() == 0;
+}
+
+template <class I, class A, class C>
+inline auto bucketed_vector<I, A, C>::buckets() const noexcept -> size_type
+{
+    return _buckets.size();
+}
+
+template <class I, class A, class C>
+template <typename T>
+inline auto bucketed_vector<I, A, C>::count() const noexcept -> size_type
+{
+    const auto b = find_bucket<T>();
+    return b ? b->size() : 0;
+}
+
+template <class I, class A, class C>
+template <class F>
+inline void bucketed_vector<I, A, C>::for_each(F&& f)
+{
+    for (auto& b : _buckets) {
+        visit_bucket(b, f);
+    }
+}
+
+template <class I, class A, class C>
+template <class F>
+inline void bucketed_vector<I, A, C>::for_each(F&& f) const
+{
+    for (const auto& b : _buckets) {
+        visit_bucket(b, f);
+    }
+}
+
+template <class I, class A, class C>
+template <typename... Ts, class F>
+inline void bucketed_vector<I, A, C>::for_each_as(F&& f)
+{
+    for (auto& b : _buckets) {
+        visit_bucket(b, f, type_tag<Ts> {}...);
+    }
+}
+
+template <class I, class A, class C>
+template <typename... Ts, class F>
+inline void bucketed_vector<I, A, C>::for_each_as(F&& f) const
+{
+    for (const auto& b : _buckets) {
+        visit_bucket(b, f, type_tag<const Ts> {}...);
+    }
+}
+
+template <class I, class A, class C>
+inline auto bucketed_vector<I, A, C>::get_allocator() const noexcept -> allocator_type
+{
+    return allocator_type(_buckets.get_allocator());
+}
+
+template <class I, class A, class C>
+template <typename T>
+inline auto bucketed_vector<I, A, C>::bucket_of() -> bucket_type&
+{
+    const auto key = vector_impl::bucket_key<C>::template of<T>();
+    if (_last < _buckets.size() && _buckets[_last].key == key) {
+        return _buckets[_last].objects;
+    }
+    const auto it = std::find_if(
+        _buckets.begin(), _buckets.end(), [key](const bucket& b) { return b.key == key; });
+    _last = static_cast<size_type>(it - _buckets.begin());
+    if (it == _buckets.end()) {
+        _buckets.push_back(bucket { key, bucket_type(get_allocator()) });
+    }
+    return _buckets[_last].objects;
+}
+
+template <class I, class A, class C>
+template <typename T>
+inline auto bucketed_vector<I, A, C>::find_bucket() const noexcept -> const bucket_type*
+{
+    const auto key = vector_impl::bucket_key<C>::template of<T>();
+    for (const auto& b : _buckets) {
+        if (b.key == key) {
+            return &b.objects;
+        }
+    }
+    return nullptr;
+}
+
+template <class I, class A, class C>
+template <class Bucket, class F>
+inline void bucketed_vector<I, A, C>::visit_bucket(Bucket& b, F& f)
+{
+    for (auto& obj : b.objects) {
+        f(obj);
+    }
+}
+
+template <class I, class A, class C>
+template <class Bucket, class F, typename T, typename... Ts>
+inline void bucketed_vector<I, A, C>::visit_bucket(
+    Bucket& b, F& f, type_tag<T> /*unused*/, type_tag<Ts>... ts)
+{
+    static_assert(std::is_base_of<interface_type, std::remove_const_t<T>>::value,
+        "visited types must implement the interface");
+    if (b.key != vector_impl::bucket_key<C>::template of<std::remove_const_t<T>>()) {
+        visit_bucket(b, f, ts...);
+        return;
+    }
+    for (auto& obj : b.objects) {
+        f(static_cast<T&>(obj));
+    }
+}
+
+template <class I, class A, class C>
+void swap(bucketed_vector<I, A, C>& lhs, bucketed_vector<I, A, C>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+} // namespace poly
@@ -0,0 +1,416 @@
+// Copyright (c) 2016 Ferenc Nandor Janky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#pragma once
+
+#include <poly/vector.h>
+
+#include <atomic>
+#include <memory>
+
+namespace poly {
+
+/// Polymorphic vector whose copies share the objects until one of them is modified. Copying,
+/// moving, swapping and every const member function never clone the objects, clear() and
+/// assignment only release the shared objects. Every other non-const member function, including
+/// non-const element access and iterators, first clones the objects into a vector of its own
+/// (detaches) if they are shared with another copy or were allocated by an allocator that did
+/// not propagate on assignment. References and iterators obtained through non-const members
+/// must not be used for modification once the container has been copied.
+/// A range for over a non-const container detaches it as well, reading goes through a const
+/// reference, cbegin()/cend(), get() or for_each().
+/// Copies may be read and destroyed concurrently, a single container is not thread safe.
+template <class IF, class Allocator = std::allocator<IF>,
+    class CloningPolicy = delegate_cloning_policy<IF, Allocator>,
+    class Layout        = vector_layout<pointer_index>>
+class cow_vector {
+public:
+    ///////////////////////////////////////////////
+    // Member types
+    ///////////////////////////////////////////////
+    using vector_type               = vector<IF, Allocator, CloningPolicy, Layout>;
+    using interface_type            = typename vector_type::interface_type;
+    using allocator_type            = typename vector_type::allocator_type;
+    using interface_reference       = typename vector_type::interface_reference;
+    using const_interface_reference = typename vector_type::const_interface_reference;
+    using size_type                 = typename vector_type::size_type;
+    using iterator                  = typename vector_type::iterator;
+    using const_iterator            = typename vector_type::const_iterator;
+    ///////////////////////////////////////////////
+    // Ctors,Dtors & assignment
+    ///////////////////////////////////////////////
+    cow_vector() = default;
+    explicit cow_vector(const allocator_type& alloc);
+    /// shares the objects of other
+    cow_vector(const cow_vector& other);
+    cow_vector(cow_vector&& other) noexcept = default;
+    /// takes over the objects of v
+    explicit cow_vector(vector_type&& v);
+
+    /// the assignments share the objects of rhs and take over its allocator only if it
+    /// propagates; the objects are cloned with the allocator of the container on detaching
+    cow_vector& operator=(const cow_vector& rhs);
+    cow_vector& operator=(cow_vector&& rhs) noexcept;
+    ///////////////////////////////////////////////
+    // Modifiers
+    ///////////////////////////////////////////////
+    template <typename T>
+    std::enable_if_t<std::is_base_of<interface_type, std::decay_t<T>>::value, void> push_back(
+        T&& obj);
+
+    template <typename T, typename... Args>
+    std::enable_if_t<std::is_base_of<interface_type, T>::value, interface_reference> emplace_back(
+        Args&&... args);
+
+    void pop_back();
+    /// keeps the storage if it is not shared, releases the shared objects otherwise
+    void clear() noexcept;
+    void swap(cow_vector& x) noexcept;
+    /// the iterators may also come from before the container was detached
+    iterator erase(const_iterator position);
+    iterator erase(const_iterator first, const_iterator last);
+    void     reserve(size_type n);
+    /// detaches the container and returns its vector for any other modification
+    vector_type& mutate();
+    ///////////////////////////////////////////////
+    // Iterators
+    ///////////////////////////////////////////////
+    iterator       begin();
+    iterator       end();
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+    ///////////////////////////////////////////////
+    // Processing
+    ///////////////////////////////////////////////
+    /// calls f with every object as const, never detaches
+    template <class F> void for_each(F&& f) const;
+    ///////////////////////////////////////////////
+    // Capacity
+    ///////////////////////////////////////////////
+    size_type size() const noexcept;
+    size_type capacity() const noexcept;
+    bool      empty() const noexcept;
+    ///////////////////////////////////////////////
+    // Element access
+    ///////////////////////////////////////////////
+    interface_reference       operator[](size_type n);
+    const_interface_reference operator[](size_type n) const noexcept;
+    interface_reference       at(size_type n);
+    const_interface_reference at(size_type n) const;
+    interface_reference       front();
+    const_interface_reference front() const noexcept;
+    interface_reference       back();
+    const_interface_reference back() const noexcept;
+    /// read only view of the objects, never detaches; an empty container that never had objects
+    /// creates its vector with its allocator
+    const vector_type& get() const;
+    ////////////////////////////
+    // Sharing
+    ////////////////////////////
+    /// number of containers sharing the objects, 0 if there are none
+    size_type use_count() const noexcept;
+    /// whether modifying the container does not need to clone the objects
+    bool unique() const noexcept;
+    ////////////////////////////
+    // Misc.
+    ////////////////////////////
+    allocator_type get_allocator() const noexcept;
+
+private:
+    using allocator_traits = std::allocator_traits<allocator_type>;
+
+    allocator_type                       _alloc;
+    mutable std::shared_ptr<vector_type> _shared;
+};
+
+template <class I, class A, class C, class L>
+inline cow_vector<I, A, C, L>::cow_vector(const allocator_type& alloc)
+    : _alloc(alloc)
+{
+}
+
+template <class I, class A, class C, class L>
+inline cow_vector<I, A, C, L>::cow_vector(const cow_vector& other)
+    : _alloc(allocator_traits::select_on_container_copy_construction(other._alloc))
+    , _shared(other._shared)
+{
+}
+
+template <class I, class A, class C, class L>
+inline cow_vector<I, A, C, L>::cow_vector(vector_type&& v)
+    : _alloc(v.get_allocator())
+    , _shared(std::allocate_shared<vector_type>(_alloc, std::move(v)))
+{
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::operator=(const cow_vector& rhs) -> cow_vector&
+{
+    /*constexpr*/ if (allocator_traits::propagate_on_container_copy_assignment::value) {
+        _alloc = rhs._alloc;
+    }
+    _shared = rhs._shared;
+    return *this;
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::operator=(cow_vector&& rhs) noexcept -> cow_vector&
+{
+    /*constexpr*/ if (allocator_traits::propagate_on_container_move_assignment::value) {
+        _alloc = std::move(rhs._alloc);
+    }
+    _shared = std::move(rhs._shared);
+    return *this;
+}
+
+template <class I, class A, class C, class L>
+template <typename T>
+inline auto cow_vector<I, A, C, L>::push_back(T&& obj)
+    -> std::enable_if_t<std::is_base_of<interface_type, std::decay_t<T>>::value>
+{
+    mutate().push_back(std::forward<T>(obj));
+}
+
+template <class I, class A, class C, class L>
+template <typename T, typename... Args>
+inline auto cow_vector<I, A, C, L>::emplace_back(Args&&... args)
+    -> std::enable_if_t<std::is_base_of<interface_type, T>::value, interface_reference>
+{
+    return mutate().template emplace_back<T>(std::forward<Args>(args)...);
+}
+
+template <class I, class A, class C, class L> inline void cow_vector<I, A, C, L>::pop_back()
+{
+    mutate().pop_back();
+}
+
+template <class I, class A, class C, class L> inline void cow_vector<I, A, C, L>::clear() noexcept
+{
+    if (unique()) {
+        _shared->clear();
+    } else {
+        _shared.reset();
+    }
+}
+
+template <class I, class A, class C, class L>
+inline void cow_vector<I, A, C, L>::swap(cow_vector& x) noexcept
+{
+    using std::swap;
+    /*constexpr*/ if (allocator_traits::propagate_on_container_swap::value) {
+        swap(_alloc, x._alloc);
+    }
+    _shared.swap(x._shared);
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::erase(const_iterator position) -> iterator
+{
+    const auto n = position - cbegin();
+    auto&      v = mutate();
+    return v.erase(v.cbegin() + n);
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::erase(const_iterator first, const_iterator last) -> iterator
+{
+    const auto n     = first - cbegin();
+    const auto count = last - first;
+    auto&      v     = mutate();
+    return v.erase(v.cbegin() + n, v.cbegin() + n + count);
+}
+
+template <class I, class A, class C, class L>
+inline void cow_vector<I, A, C, L>::reserve(size_type n)
+{
+    mutate().reserve(n);
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::mutate() -> vector_type&
+{
+    if (!_shared) {
+        _shared = std::allocate_shared<vector_type>(_alloc, _alloc);
+    } else if (_shared->get_allocator() != _alloc) {
+        // assigned from a container whose allocator did not propagate
+        auto v = std::allocate_shared<vector_type>(_alloc, _alloc);
+        v->assign(_shared->cbegin(), _shared->cend());
+        _shared = std::move(v);
+    } else if (_shared.use_count() != 1) {
+        _shared = std::allocate_shared<vector_type>(_alloc, *_shared);
+    } else {
+        // pairs with the release of the last other owner, whose reads happened before
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *_shared;
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::begin() -> iterator
+{
+    return mutate().begin();
+}
+
+template <class I, class A, class C, class L> inline auto cow_vector<I, A, C, L>::end() -> iterator
+{
+    return mutate().end();
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::begin() const noexcept -> const_iterator
+{
+    return _shared ? _shared->cbegin() : const_iterator {};
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::end() const noexcept -> const_iterator
+{
+    return _shared ? _shared->cend() : const_iterator {};
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::cbegin() const noexcept -> const_iterator
+{
+    return _shared ? _shared->cbegin() : const_iterator {};
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::cend() const noexcept -> const_iterator
+{
+    return _shared ? _shared->cend() : const_iterator {};
+}
+
+template <class I, class A, class C, class L>
+template <class F>
+inline void cow_vector<I, A, C, L>::for_each(F&& f) const
+{
+    for (auto it = cbegin(); it != cend(); ++it) {
+        f(*it);
+    }
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::size() const noexcept -> size_type
+{
+    return _shared ? _shared->size() : 0;
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::capacity() const noexcept -> size_type
+{
+    return _shared ? _shared->capacity() : 0;
+}
+
+template <class I, class A, class C, class L>
+inline bool cow_vector<I, A, C, L>::empty() const noexcept
+{
+    return size() == 0;
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::operator[](size_type n) -> interface_reference
+{
+    return mutate()[n];
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::operator[](size_type n) const noexcept
+    -> const_interface_reference
+{
+    return (*_shared)[n];
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::at(size_type n) -> interface_reference
+{
+    if (n >= size()) {
+        throw std::out_of_range { "poly::cow_vector out of range access" };
+    }
+    return mutate()[n];
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::at(size_type n) const -> const_interface_reference
+{
+    if (n >= size()) {
+        throw std::out_of_range { "poly::cow_vector out of range access" };
+    }
+    return (*_shared)[n];
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::front() -> interface_reference
+{
+    return mutate().front();
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::front() const noexcept -> const_interface_reference
+{
+    return _shared->front();
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::back() -> interface_reference
+{
+    return mutate().back();
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::back() const noexcept -> const_interface_reference
+{
+    return _shared->back();
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::get() const -> const vector_type&
+{
+    if (!_shared) {
+        _shared = std::allocate_shared<vector_type>(_alloc, _alloc);
+    }
+    return *_shared;
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::use_count() const noexcept -> size_type
+{
+    return static_cast<size_type>(_shared.use_count());
+}
+
+template <class I, class A, class C, class L>
+inline bool cow_vector<I, A, C, L>::unique() const noexcept
+{
+    return _shared.use_count() == 1;
+}
+
+template <class I, class A, class C, class L>
+inline auto cow_vector<I, A, C, L>::get_allocator() const noexcept -> allocator_type
+{
+    return _alloc;
+}
+
+template <class I, class A, class C, class L>
+void swap(cow_vector<I, A, C, L>& lhs, cow_vector<I, A, C, L>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+} // namespace poly
@@ -28,7 +28,8 @@ namespace poly {
 namespace vector_impl {
 
 #if defined(POLY_VECTOR_HAS_CXX_DISJUNCTION)
-    template <typename... T> using or_type_t = typename std::disjunction<T...>::type;
+    template <typename... T> using or_type_t  = typename std::disjunction<T...>::type;
+    template <typename... T> using and_type_t = typename std::conjunction<T...>::type;
 #else
     template <typename... Ts> struct OrType;
 
@@ -49,6 +50,25 @@ namespace vector_impl {
 
     template <typename... Ts> using or_type_t = typename OrType<Ts...>::type;
 
+    template <typename... Ts> struct AndType;
+
+    template <typename... Ts> struct AndType<::std::true_type, Ts...> {
+        static constexpr bool value = AndType<Ts...>::value;
+        using type                  = typename AndType<Ts...>::type;
+    };
+
+    template <typename... Ts> struct AndType<::std::false_type, Ts...> {
+        static constexpr bool value = false;
+        using type                  = ::std::false_type;
+    };
+
+    template <> struct AndType<> {
+        static constexpr bool value = true;
+        using type                  = ::std::true_type;
+    };
+
+    template <typename... Ts> using and_type_t = typename AndType<Ts...>::type;
+
 #endif
 
 #if defined(POLY_VECTOR_HAS_CXX_ALLOCATOR_ALWAYS_EQUAL)
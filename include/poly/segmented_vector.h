@@ -0,0 +1,655 @@
+// Copyright (c) 2016 Ferenc Nandor Janky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#pragma once
+
+#include <poly/vector.h>
+
+namespace poly {
+
+/// Polymorphic sequence whose objects are stored in geometrically growing segments. A full
+/// segment is never reallocated, a new one is chained after it instead, so appending never
+/// moves or clones the existing objects and references to them stay valid until they are
+/// erased. Only the index of the objects is reallocated on growth.
+template <class IF, class Allocator = std::allocator<IF>,
+    class CloningPolicy = delegate_cloning_policy<IF, Allocator>>
+class segmented_vector
+    : private vector_impl::allocator_base<
+          typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>> {
+public:
+    ///////////////////////////////////////////////
+    // Member types
+    ///////////////////////////////////////////////
+    using interface_type = std::decay_t<IF>;
+    using allocator_type =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>;
+
+#ifdef POLY_VECTOR_MSVC_WORKAROUND
+    using interface_allocator_type =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<IF>;
+#else
+    using interface_allocator_type = Allocator;
+#endif
+
+    using interface_allocator_traits = std::allocator_traits<interface_allocator_type>;
+    using allocator_traits           = std::allocator_traits<allocator_type>;
+    using my_base                    = vector_impl::allocator_base<allocator_type>;
+    using interface_reference        = std::add_lvalue_reference_t<interface_type>;
+    using const_interface_reference = std::add_lvalue_reference_t<std::add_const_t<interface_type>>;
+    using pointer                   = typename my_base::pointer;
+    using void_pointer              = typename my_base::void_pointer;
+    using size_type                 = std::size_t;
+    using cloning_policy            = CloningPolicy;
+    using elem_ptr                  = vector_elem_ptr<cloning_policy, interface_allocator_traits>;
+    using iterator                  = vector_iterator<elem_ptr>;
+    using const_iterator            = vector_iterator<elem_ptr const>;
+    using reverse_iterator          = std::reverse_iterator<iterator>;
+    using const_reverse_iterator    = std::reverse_iterator<const_iterator>;
+    using cloning_policy_traits = vector_impl::cloning_policy_traits<CloningPolicy, interface_type,
+        interface_allocator_type>;
+
+    static_assert(std::is_same<IF, interface_type>::value,
+        "interface type must be a non-cv qualified user defined type");
+    static_assert(std::is_polymorphic<interface_type>::value, "interface_type is not polymorphic");
+    static_assert(vector_impl::is_cloning_policy<CloningPolicy, interface_type,
+                      interface_allocator_type>::value,
+        "invalid cloning policy type");
+    static constexpr auto default_avg_size     = 4 * sizeof(void*);
+    static constexpr auto initial_segment_size = 16 * default_avg_size;
+    ///////////////////////////////////////////////
+    // Ctors,Dtors & assignment
+    ///////////////////////////////////////////////
+    segmented_vector();
+    explicit segmented_vector(const allocator_type& alloc);
+    /// the copy stores every object in a single segment
+    segmented_vector(const segmented_vector& other);
+    segmented_vector(const segmented_vector& other, const allocator_type& alloc);
+    segmented_vector(segmented_vector&& other) noexcept;
+    ~segmented_vector();
+
+    segmented_vector& operator=(const segmented_vector& rhs);
+    /// clones the objects of rhs if the allocators differ and the allocator does not propagate
+    segmented_vector& operator=(segmented_vector&& rhs) noexcept(
+        my_base::propagate_on_container_move_assignment::value
+        || my_base::allocator_is_always_equal::value);
+    ///////////////////////////////////////////////
+    // Modifiers
+    ///////////////////////////////////////////////
+    template <typename T>
+    std::enable_if_t<std::is_base_of<interface_type, std::decay_t<T>>::value, void> push_back(
+        T&& obj);
+
+    template <typename T, typename... Args>
+    std::enable_if_t<std::is_base_of<interface_type, T>::value, interface_reference> emplace_back(
+        Args&&... args);
+
+    void pop_back() noexcept;
+    /// releases every segment but the last one
+    void clear() noexcept;
+    void swap(segmented_vector& x) noexcept;
+    /// the storage of the erased objects is only reused if they were the last ones allocated
+    iterator erase(const_iterator position);
+    iterator erase(const_iterator first, const_iterator last);
+    ///////////////////////////////////////////////
+    // Iterators
+    ///////////////////////////////////////////////
+    iterator               begin() noexcept;
+    iterator               end() noexcept;
+    const_iterator         begin() const noexcept;
+    const_iterator         end() const noexcept;
+    reverse_iterator       rbegin() noexcept;
+    reverse_iterator       rend() noexcept;
+    const_reverse_iterator rbegin() const noexcept;
+    const_reverse_iterator rend() const noexcept;
+    const_iterator         cbegin() const noexcept;
+    const_iterator         cend() const noexcept;
+    ///////////////////////////////////////////////
+    // Capacity
+    ///////////////////////////////////////////////
+    size_t    size() const noexcept;
+    size_type capacity() const noexcept;
+    bool      empty() const noexcept;
+    /// number of object storage segments
+    size_t segments() const noexcept;
+    /// reserves index entries only, the object storage grows by segments
+    void reserve(size_type n);
+    ///////////////////////////////////////////////
+    // Element access
+    ///////////////////////////////////////////////
+    interface_reference       operator[](size_t n) noexcept;
+    const_interface_reference operator[](size_t n) const noexcept;
+    interface_reference       at(size_t n);
+    const_interface_reference at(size_t n) const;
+    interface_reference       front() noexcept;
+    const_interface_reference front() const noexcept;
+    interface_reference       back() noexcept;
+    const_interface_reference back() const noexcept;
+    ////////////////////////////
+    // Misc.
+    ////////////////////////////
+    allocator_type get_allocator() const noexcept;
+
+private:
+    template <typename T> using type_tag = type_tag<T>;
+
+    /// placed at the beginning of every segment, chaining it to the previous one
+    struct segment_header {
+        void_pointer prev;
+        size_t       size;
+    };
+
+    using elem_ptr_pointer = typename allocator_traits::template rebind_traits<elem_ptr>::pointer;
+    using elem_ptr_const_pointer =
+        typename allocator_traits::template rebind_traits<elem_ptr>::const_pointer;
+    using header_pointer =
+        typename allocator_traits::template rebind_traits<segment_header>::pointer;
+
+    static constexpr size_t header_size
+        = (sizeof(segment_header) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t)
+        * alignof(std::max_align_t);
+
+    my_base&               base() noexcept;
+    const my_base&         base() const noexcept;
+    elem_ptr_pointer       begin_elem() noexcept;
+    elem_ptr_const_pointer begin_elem() const noexcept;
+    void_pointer           object_storage(size_t size, size_t align);
+    void                   add_segment(size_t min_size);
+    void                   release_segments(void_pointer last) noexcept;
+    void                   grow_index(size_t n);
+    /// destroys the object of the entry, the entry itself is left to the caller
+    void                   destroy_elem(elem_ptr_pointer p) noexcept;
+    void                   tidy() noexcept;
+    void move_assign_impl(segmented_vector&& rhs, std::true_type /*unused*/) noexcept;
+    void move_assign_impl(segmented_vector&& rhs, std::false_type /*unused*/);
+    template <typename Propagate>
+    void swap_with_propagate(segmented_vector& x, Propagate /*unused*/) noexcept;
+
+    elem_ptr_pointer _free_elem;
+    void_pointer     _segment;
+    void_pointer     _free_storage;
+    void_pointer     _end_segment;
+};
+
+template <class I, class A, class C>
+inline segmented_vector<I, A, C>::segmented_vector()
+    : segmented_vector(allocator_type())
+{
+}
+
+template <class I, class A, class C>
+inline segmented_vector<I, A, C>::segmented_vector(const allocator_type& alloc)
+    : my_base(alloc)
+    , _free_elem {}
+    , _segment {}
+    , _free_storage {}
+    , _end_segment {}
+{
+}
+
+template <class I, class A, class C>
+inline segmented_vector<I, A, C>::segmented_vector(const segmented_vector& other)
+    : segmented_vector(other,
+        allocator_traits::select_on_container_copy_construction(other.base().get_allocator_ref()))
+{
+}
+
+template <class I, class A, class C>
+inline segmented_vector<I, A, C>::segmented_vector(
+    const segmented_vector& other, const allocator_type& alloc)
+    : my_base(alloc)
+    , _free_elem {}
+    , _segment {}
+    , _free_storage {}
+    , _end_segment {}
+{
+    if (other.capacity()) {
+        base().allocate(other.capacity() * sizeof(elem_ptr));
+    }
+    _free_elem    = begin_elem();
+    size_t extent = 0;
+    for (auto elem = other.begin_elem(); elem != other._free_elem; ++elem) {
+        extent += elem->size() + elem->align() - 1;
+    }
+    try {
+        if (extent) {
+            add_segment(header_size + extent);
+        }
+        for (auto elem = other.begin_elem(); elem != other._free_elem; ++elem) {
+            auto ns  = object_storage(elem->size(), elem->align());
+            auto obj = elem->policy().clone(
+                base().get_allocator_ref(), elem->object(nullptr), ns);
+            base().construct(_free_elem, *elem);
+            _free_elem->place(nullptr, ns, obj);
+            ++_free_elem;
+            _free_storage = static_cast<pointer>(ns) + elem->size();
+        }
+    } catch (...) {
+        tidy();
+        throw;
+    }
+}
+
+template <class I, class A, class C>
+inline segmented_vector<I, A, C>::segmented_vector(segmented_vector&& other) noexcept
+    : my_base(std::move(other.base()))
+    , _free_elem { other._free_elem }
+    , _segment { other._segment }
+    , _free_storage { other._free_storage }
+    , _end_segment { other._end_segment }
+{
+    other._free_elem = nullptr;
+    other._segment = other._free_storage = other._end_segment = nullptr;
+}
+
+template <class I, class A, class C> inline segmented_vector<I, A, C>::~segmented_vector()
+{
+    tidy();
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::operator=(const segmented_vector& rhs) -> segmented_vector&
+{
+    using propagate = typename my_base::propagate_on_container_copy_assignment;
+    if (this != &rhs) {
+        // the copy is made with the allocator the container keeps after the assignment
+        segmented_vector tmp(rhs, propagate::value ? rhs.get_allocator() : get_allocator());
+        swap_with_propagate(tmp, propagate {});
+    }
+    return *this;
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::operator=(segmented_vector&& rhs) noexcept(
+    my_base::propagate_on_container_move_assignment::value
+    || my_base::allocator_is_always_equal::value) -> segmented_vector&
+{
+    if (this != &rhs) {
+        move_assign_impl(std::move(rhs),
+            std::integral_constant<bool,
+                my_base::propagate_on_container_move_assignment::value
+                    || my_base::allocator_is_always_equal::value> {});
+    }
+    return *this;
+}
+
+template <class I, class A, class C>
+template <typename T>
+inline auto segmented_vector<I, A, C>::push_back(T&& obj)
+    -> std::enable_if_t<std::is_base_of<interface_type, std::decay_t<T>>::value>
+{
+    emplace_back<std::decay_t<T>>(std::forward<T>(obj));
+}
+
+template <class I, class A, class C>
+template <typename T, typename... Args>
+inline auto segmented_vector<I, A, C>::emplace_back(Args&&... args)
+    -> std::enable_if_t<std::is_base_of<interface_type, T>::value, interface_reference>
+{
+    using traits = typename allocator_traits::template rebind_traits<T>;
+    if (_free_elem == static_cast<elem_ptr_pointer>(base().end_storage())) {
+        grow_index(std::max(capacity() * 2, size_t(1)));
+    }
+    auto nas = object_storage(sizeof(T), alignof(T));
+    auto obj
+        = base().construct(static_cast<typename traits::pointer>(nas), std::forward<Args>(args)...);
+    base().construct(_free_elem, type_tag<T> {}, nas, obj);
+    ++_free_elem;
+    _free_storage = static_cast<pointer>(nas) + sizeof(T);
+    return *obj;
+}
+
+template <class I, class A, class C> inline void segmented_vector<I, A, C>::pop_back() noexcept
+{
+    destroy_elem(--_free_elem);
+    base().destroy(_free_elem);
+}
+
+template <class I, class A, class C> inline void segmented_vector<I, A, C>::clear() noexcept
+{
+    while (!empty()) {
+        pop_back();
+    }
+    if (_segment) {
+        release_segments(static_cast<header_pointer>(_segment)->prev);
+        static_cast<header_pointer>(_segment)->prev = nullptr;
+        _free_storage = static_cast<pointer>(_segment) + header_size;
+    }
+}
+
+template <class I, class A, class C>
+inline void segmented_vector<I, A, C>::swap(segmented_vector& x) noexcept
+{
+    swap_with_propagate(x, typename my_base::propagate_on_container_swap {});
+}
+
+template <class I, class A, class C>
+template <typename Propagate>
+inline void segmented_vector<I, A, C>::swap_with_propagate(
+    segmented_vector& x, Propagate /*unused*/) noexcept
+{
+    using std::swap;
+    base().swap_with_propagate(x.base(), Propagate {});
+    swap(_free_elem, x._free_elem);
+    swap(_segment, x._segment);
+    swap(_free_storage, x._free_storage);
+    swap(_end_segment, x._end_segment);
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::erase(const_iterator position) -> iterator
+{
+    return erase(position, position + 1);
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::erase(const_iterator first, const_iterator last) -> iterator
+{
+    const auto eptr_first = begin_elem() + (first - begin());
+    const auto eptr_last  = begin_elem() + (last - begin());
+    for (auto p = eptr_last; p != eptr_first;) {
+        destroy_elem(--p);
+    }
+    const auto new_end = std::copy(eptr_last, _free_elem, eptr_first);
+    while (_free_elem != new_end) {
+        base().destroy(--_free_elem);
+    }
+    return iterator(eptr_first);
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::begin() noexcept -> iterator
+{
+    return iterator(begin_elem());
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::end() noexcept -> iterator
+{
+    return iterator(_free_elem);
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::begin() const noexcept -> const_iterator
+{
+    return const_iterator(begin_elem());
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::end() const noexcept -> const_iterator
+{
+    return const_iterator(_free_elem);
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::rbegin() noexcept -> reverse_iterator
+{
+    return reverse_iterator(end());
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::rend() noexcept -> reverse_iterator
+{
+    return reverse_iterator(begin());
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::rbegin() const noexcept -> const_reverse_iterator
+{
+    return const_reverse_iterator(end());
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::rend() const noexcept -> const_reverse_iterator
+{
+    return const_reverse_iterator(begin());
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::cbegin() const noexcept -> const_iterator
+{
+    return begin();
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::cend() const noexcept -> const_iterator
+{
+    return end();
+}
+
+template <class I, class A, class C> inline size_t segmented_vector<I, A, C>::size() const noexcept
+{
+    return static_cast<size_t>(_free_elem - begin_elem());
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::capacity() const noexcept -> size_type
+{
+    return static_cast<size_t>(base().size()) / sizeof(elem_ptr);
+}
+
+template <class I, class A, class C> inline bool segmented_vector<I, A, C>::empty() const noexcept
+{
+    return _free_elem == begin_elem();
+}
+
+template <class I, class A, class C>
+inline size_t segmented_vector<I, A, C>::segments() const noexcept
+{
+    size_t n = 0;
+    for (auto s = _segment; s; s = static_cast<header_pointer>(s)->prev) {
+        ++n;
+    }
+    return n;
+}
+
+template <class I, class A, class C> inline void segmented_vector<I, A, C>::reserve(size_type n)
+{
+    if (n > capacity()) {
+        grow_index(n);
+    }
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::operator[](size_t n) noexcept -> interface_reference
+{
+    return *begin_elem()[n].object(nullptr);
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::operator[](size_t n) const noexcept
+    -> const_interface_reference
+{
+    return *begin_elem()[n].object(nullptr);
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::at(size_t n) -> interface_reference
+{
+    if (n >= size()) {
+        throw std::out_of_range { "poly::segmented_vector out of range access" };
+    }
+    return (*this)[n];
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::at(size_t n) const -> const_interface_reference
+{
+    if (n >= size()) {
+        throw std::out_of_range { "poly::segmented_vector out of range access" };
+    }
+    return (*this)[n];
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::front() noexcept -> interface_reference
+{
+    return (*this)[0];
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::front() const noexcept -> const_interface_reference
+{
+    return (*this)[0];
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::back() noexcept -> interface_reference
+{
+    return (*this)[size() - 1];
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::back() const noexcept -> const_interface_reference
+{
+    return (*this)[size() - 1];
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::get_allocator() const noexcept -> allocator_type
+{
+    return base().get_allocator_ref();
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::base() noexcept -> my_base&
+{
+    return *this;
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::base() const noexcept -> const my_base&
+{
+    return *this;
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::begin_elem() noexcept -> elem_ptr_pointer
+{
+    return static_cast<elem_ptr_pointer>(base().storage());
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::begin_elem() const noexcept -> elem_ptr_const_pointer
+{
+    return static_cast<elem_ptr_const_pointer>(base().storage());
+}
+
+template <class I, class A, class C>
+inline auto segmented_vector<I, A, C>::object_storage(size_t size, size_t align) -> void_pointer
+{
+    const auto aligned = [align](void_pointer p) {
+        auto v = static_cast<pointer>(p) - static_cast<pointer>(nullptr);
+        return static_cast<pointer>(p) + (((v + align - 1) / align) * align - v);
+    };
+    if (!_segment || aligned(_free_storage) + size > static_cast<pointer>(_end_segment)) {
+        add_segment(header_size + size + align - 1);
+    }
+    return aligned(_free_storage);
+}
+
+template <class I, class A, class C>
+inline void segmented_vector<I, A, C>::add_segment(size_t min_size)
+{
+    const auto last = _segment ? static_cast<header_pointer>(_segment)->size : 0;
+    const auto size = std::max({ min_size, 2 * last, initial_segment_size });
+    auto       s    = base().get_allocator_ref().allocate(size);
+    base().construct(static_cast<header_pointer>(static_cast<void_pointer>(s)),
+        segment_header { _segment, size });
+    _segment      = s;
+    _free_storage = s + header_size;
+    _end_segment  = s + size;
+}
+
+template <class I, class A, class C>
+inline void segmented_vector<I, A, C>::release_segments(void_pointer last) noexcept
+{
+    while (last) {
+        const auto header = static_cast<header_pointer>(last);
+        const auto prev   = header->prev;
+        const auto size   = header->size;
+        base().destroy(header);
+        base().get_allocator_ref().deallocate(static_cast<pointer>(last), size);
+        last = prev;
+    }
+}
+
+template <class I, class A, class C> inline void segmented_vector<I, A, C>::grow_index(size_t n)
+{
+    // the entries do not depend on their own location, so growing the index is a plain copy
+    my_base    index(n * sizeof(elem_ptr), base().get_allocator_ref());
+    const auto sz  = size();
+    auto       dst = static_cast<elem_ptr_pointer>(index.storage());
+    for (auto elem = begin_elem(); elem != _free_elem; ++elem, ++dst) {
+        index.construct(dst, *elem);
+        base().destroy(elem);
+    }
+    base().swap(index);
+    _free_elem = begin_elem() + sz;
+}
+
+template <class I, class A, class C>
+inline void segmented_vector<I, A, C>::destroy_elem(elem_ptr_pointer p) noexcept
+{
+    const auto storage = p->storage(nullptr);
+    const auto end     = static_cast<pointer>(storage) + p->size();
+    cloning_policy_traits::destroy(p->policy(), base().get_allocator_ref(), p->object(nullptr));
+    if (end == _free_storage) {
+        _free_storage = storage;
+    }
+}
+
+template <class I, class A, class C> inline void segmented_vector<I, A, C>::tidy() noexcept
+{
+    while (!empty()) {
+        pop_back();
+    }
+    release_segments(_segment);
+    _segment = _free_storage = _end_segment = nullptr;
+    _free_elem                              = nullptr;
+    my_base::tidy();
+}
+
+template <class I, class A, class C>
+inline void segmented_vector<I, A, C>::move_assign_impl(
+    segmented_vector&& rhs, std::true_type /*unused*/) noexcept
+{
+    // the storage of rhs can be released by the allocator the container keeps
+    segmented_vector tmp(std::move(rhs));
+    swap_with_propagate(tmp, typename my_base::propagate_on_container_move_assignment {});
+}
+
+template <class I, class A, class C>
+inline void segmented_vector<I, A, C>::move_assign_impl(
+    segmented_vector&& rhs, std::false_type /*unused*/)
+{
+    if (base().get_allocator_ref() == rhs.base().get_allocator_ref()) {
+        move_assign_impl(std::move(rhs), std::true_type {});
+        return;
+    }
+    segmented_vector tmp(rhs, get_allocator());
+    swap_with_propagate(tmp, std::false_type {});
+}
+
+template <class I, class A, class C>
+void swap(segmented_vector<I, A, C>& lhs, segmented_vector<I, A, C>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+} // namespace poly
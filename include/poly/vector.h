@@ -22,16 +22,21 @@
 #include <poly/detail/vector_impl.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <tuple>
 #include <type_traits>
+#include <typeinfo>
 #include <utility>
 
 namespace poly {
@@ -39,6 +44,42 @@ template <typename T> struct type_tag {
     using type = T;
 };
 
+/// Specialize it as std::true_type for types that can be copied by copying their bytes, which
+/// polymorphic types never are in the sense of the standard, so the container copies them in bulk.
+template <typename T> struct is_trivially_copyable : std::is_trivially_copyable<T> {
+};
+
+/// Specialize it as std::true_type for types that can be relocated by copying their bytes to the
+/// new location and forgetting the old object, so the container relocates them in bulk.
+template <typename T> struct is_trivially_relocatable : is_trivially_copyable<T> {
+};
+
+/// Specialize it as std::true_type for types whose destructor has no effect, e.g. the virtual
+/// destructor inherited from the interface, so the container never calls it.
+template <typename T> struct is_trivially_destructible : std::is_trivially_destructible<T> {
+};
+
+/// expected number of objects with the given size and alignment, see vector::reserve_for
+struct object_count {
+    size_t size;
+    size_t align;
+    size_t count;
+};
+
+template <typename T> constexpr object_count count_of(size_t n) noexcept
+{
+    return object_count { sizeof(T), alignof(T), n };
+}
+
+/// storage left between the objects of a vector, see vector::fragmentation
+struct fragmentation_info {
+    /// number and total size of the freed ranges new objects can be placed into
+    size_t holes;
+    size_t hole_bytes;
+    /// bytes below the free storage not taken by any object, padding included
+    size_t unused_bytes;
+};
+
 namespace vector_impl {
 
     // namespace concepts {
@@ -100,6 +141,66 @@ namespace vector_impl {
     using is_noexcept_movable_t =
         typename is_noexcept_movable<TT, has_noexcept_movable<TT>::value>::type;
 
+    template <class TT> struct has_trivially_relocatable {
+        template <class U>
+        static std::true_type  test(U&&, typename std::decay_t<U>::trivially_relocatable*);
+        static std::false_type test(...);
+        static constexpr bool  value
+            = std::is_same<std::true_type, decltype(test(std::declval<TT>(), nullptr))>::value;
+    };
+
+    template <class TT, bool HasType> struct is_trivially_relocatable_policy {
+        using type = typename TT::trivially_relocatable;
+    };
+    template <class TT> struct is_trivially_relocatable_policy<TT, false> {
+        using type = std::false_type;
+    };
+
+    /// a cloning policy may declare all the elements it handles trivially relocatable
+    template <class TT>
+    using is_trivially_relocatable_policy_t =
+        typename is_trivially_relocatable_policy<TT, has_trivially_relocatable<TT>::value>::type;
+
+    template <class TT> struct has_trivially_copyable {
+        template <class U>
+        static std::true_type  test(U&&, typename std::decay_t<U>::trivially_copyable*);
+        static std::false_type test(...);
+        static constexpr bool  value
+            = std::is_same<std::true_type, decltype(test(std::declval<TT>(), nullptr))>::value;
+    };
+
+    template <class TT, bool HasType> struct is_trivially_copyable_policy {
+        using type = typename TT::trivially_copyable;
+    };
+    template <class TT> struct is_trivially_copyable_policy<TT, false> {
+        using type = std::false_type;
+    };
+
+    /// a cloning policy may declare all the elements it handles trivially copyable
+    template <class TT>
+    using is_trivially_copyable_policy_t =
+        typename is_trivially_copyable_policy<TT, has_trivially_copyable<TT>::value>::type;
+
+    template <class TT> struct has_trivially_destructible {
+        template <class U>
+        static std::true_type  test(U&&, typename std::decay_t<U>::trivially_destructible*);
+        static std::false_type test(...);
+        static constexpr bool  value
+            = std::is_same<std::true_type, decltype(test(std::declval<TT>(), nullptr))>::value;
+    };
+
+    template <class TT, bool HasType> struct is_trivially_destructible_policy {
+        using type = typename TT::trivially_destructible;
+    };
+    template <class TT> struct is_trivially_destructible_policy<TT, false> {
+        using type = std::false_type;
+    };
+
+    /// a cloning policy may declare all the elements it handles trivially destructible
+    template <class TT>
+    using is_trivially_destructible_policy_t = typename is_trivially_destructible_policy<TT,
+        has_trivially_destructible<TT>::value>::type;
+
     template <class T, class IF, class A> struct is_cloning_policy_impl {
         // TODO(fecjanky): add check for is constructible from type_tag
         using void_ptr = typename std::allocator_traits<A>::void_pointer;
@@ -126,8 +227,18 @@ namespace vector_impl {
                 = std::is_same<pointer*, decltype(test(std::declval<TT>()))>::value;
         };
 
-        using has_move_t  = std::integral_constant<bool, has_move_impl<T>::value>;
-        using has_clone_t = std::integral_constant<bool, has_clone_impl<T>::value>;
+        template <class TT> struct has_destroy_impl {
+            template <class U>
+            static decltype(std::declval<U>().destroy(std::declval<A>(), std::declval<pointer>()))*
+                                   test(U&&);
+            static std::false_type test(...);
+            static constexpr bool  value
+                = std::is_same<void*, decltype(test(std::declval<TT>()))>::value;
+        };
+
+        using has_move_t    = std::integral_constant<bool, has_move_impl<T>::value>;
+        using has_clone_t   = std::integral_constant<bool, has_clone_impl<T>::value>;
+        using has_destroy_t = std::integral_constant<bool, has_destroy_impl<T>::value>;
         // TODO(fecjanky): provide traits defaults for Allocator type, pointer
         // and void_pointer types
         static constexpr bool value
@@ -174,11 +285,17 @@ namespace vector_impl {
         }
 
         allocator_base(const allocator_base& a)
+            : allocator_base(a, static_cast<size_t>(a.size()))
+        {
+        }
+
+        /// copies the allocator of a, with storage of n bytes
+        allocator_base(const allocator_base& a, size_t n)
             : allocator_base(
                 allocator_traits::select_on_container_copy_construction(a.get_allocator_ref()))
         {
-            if (a.size()) {
-                allocate(a.size());
+            if (n) {
+                allocate(n);
             }
         }
 
@@ -192,36 +309,44 @@ namespace vector_impl {
 
         allocator_base& operator=(const allocator_base& a)
         {
-            return copy_assign_impl(a, propagate_on_container_copy_assignment {});
+            return assign(a, static_cast<size_t>(a.size()));
         }
 
         allocator_base& operator=(allocator_base&& a) = delete;
 
-        allocator_base& copy_assign_impl(const allocator_base& a, std::true_type /*unused*/)
+        /// copy assignment with storage of n bytes
+        allocator_base& assign(const allocator_base& a, size_t n)
+        {
+            return copy_assign_impl(a, n, propagate_on_container_copy_assignment {});
+        }
+
+        allocator_base& copy_assign_impl(
+            const allocator_base& a, size_t n, std::true_type /*unused*/)
         {
             static_assert(std::is_nothrow_copy_assignable<allocator_type>::value,
                 "allocator copy assignment must not throw");
             pointer s      = nullptr;
             auto    a_copy = a.get_allocator_ref();
-            if (a.size()) {
-                s = a_copy.allocate(a.size());
+            if (n) {
+                s = a_copy.allocate(n);
             }
             tidy();
             get_allocator_ref() = std::move(a_copy);
             _storage            = s;
-            _end_storage        = s + a.size();
+            _end_storage        = s + n;
             return *this;
         }
 
-        allocator_base& copy_assign_impl(const allocator_base& a, std::false_type /*unused*/)
+        allocator_base& copy_assign_impl(
+            const allocator_base& /*unused*/, size_t n, std::false_type /*unused*/)
         {
             pointer s = nullptr;
-            if (a.size()) {
-                s = get_allocator_ref().allocate(a.size());
+            if (n) {
+                s = get_allocator_ref().allocate(n);
             }
             tidy();
             _storage     = s;
-            _end_storage = s + a.size();
+            _end_storage = s + n;
             return *this;
         }
 
@@ -296,197 +421,956 @@ namespace vector_impl {
         void_pointer _end_storage;
     };
 
-    template <class Policy, class Interface, class Allocator>
-    using is_cloning_policy = std::integral_constant<bool,
-        vector_impl::is_cloning_policy_impl<Policy, Interface, Allocator>::value>;
+    /// bounds of the index when it is allocated separately from the objects
+    template <class Allocator, class SeparateIndex> struct index_block {
+        using void_pointer = typename std::allocator_traits<Allocator>::void_pointer;
 
-    template <class Policy, class Interface, class Allocator> struct cloning_policy_traits {
-        static_assert(is_cloning_policy<Policy, Interface, Allocator>::value,
-            "policy is not a cloning policy");
-        using allocator_type   = Allocator;
-        using allocator_traits = std::allocator_traits<allocator_type>;
-        using pointer          = typename allocator_traits::pointer;
-        using void_pointer     = typename allocator_traits::void_pointer;
+        void swap_index(index_block& x) noexcept
+        {
+            using std::swap;
+            swap(_index, x._index);
+            swap(_end_index, x._end_index);
+        }
 
-        using policy_impl
-            = ::poly::vector_impl::is_cloning_policy_impl<Policy, Interface, allocator_type>;
-        using has_move_t       = typename policy_impl::has_move_t;
-        using noexcept_movable = std::integral_constant<bool,
-            vector_impl::is_noexcept_movable_t<Policy>::value && has_move_t::value>;
+        void_pointer _index {};
+        void_pointer _end_index {};
+    };
 
-        static pointer move(const Policy& p, const allocator_type& a, pointer obj,
-            void_pointer dest) noexcept(noexcept_movable::value)
+    template <class Allocator> struct index_block<Allocator, std::false_type> {
+        void swap_index(index_block& /*unused*/) noexcept { }
+    };
+
+    constexpr std::size_t log2(std::size_t n) noexcept
+    {
+        std::size_t l = 0;
+        while (n >>= 1) {
+            ++l;
+        }
+        return l;
+    }
+
+    /// size rounded up to a multiple of align
+    constexpr std::size_t padded_size(std::size_t size, std::size_t align) noexcept
+    {
+        return ((size + align - 1) / align) * align;
+    }
+
+    /// padded totals and histogram of the objects per log2 alignment class, the last class
+    /// collecting every larger alignment
+    template <bool Tracked> struct align_class_totals {
+        static constexpr size_t align_classes = 8;
+        static constexpr size_t top_class     = align_classes - 1;
+
+        align_class_totals() noexcept
+            : padded {}
+            , align_histogram {}
         {
-            return move_impl(p, a, obj, dest, typename policy_impl::has_move_t {});
         }
 
-    private:
-        static pointer move_impl(const Policy& p, const allocator_type& a, pointer obj,
-            void_pointer dest, std::true_type /*unused*/) noexcept(noexcept_movable::value)
+        void add_class(size_t size, size_t align) noexcept
         {
-            return p.move(a, obj, dest);
+            for (size_t c = 0; c < align_classes; ++c) {
+                padded[c] += padded_size(size, size_t(1) << c);
+            }
+            ++align_histogram[align_class(align)];
         }
-        static pointer move_impl(const Policy& p, const allocator_type& a, pointer obj,
-            void_pointer dest, std::false_type /*unused*/)
+
+        void remove_class(size_t size, size_t align) noexcept
         {
-            return p.clone(a, obj, dest);
+            for (size_t c = 0; c < align_classes; ++c) {
+                padded[c] -= padded_size(size, size_t(1) << c);
+            }
+            --align_histogram[align_class(align)];
         }
-    };
 
-} // namespace vector_impl
+        size_t padded_total(size_t max_align, size_t bound) const noexcept
+        {
+            const auto c = log2(max_align);
+            return c < align_classes ? padded[c] : bound;
+        }
 
-template <class Interface, class Allocator = std::allocator<Interface>,
-    typename Interface_Is_NoExcept_Movable = std::true_type>
-struct delegate_cloning_policy;
+        size_t natural_bound(size_t payload, size_t /*count*/, size_t top_align) const noexcept
+        {
+            auto bound = payload;
+            for (size_t c = 0; c < align_classes; ++c) {
+                const auto align = c == top_class ? top_align : size_t(1) << c;
+                bound += align_histogram[c] * (align - 1);
+            }
+            return bound;
+        }
 
-template <class IF, class Allocator = std::allocator<IF>,
-    /// implicit noexcept_movability when using defaults of delegate cloning
-    /// policy
-    class CloningPolicy = delegate_cloning_policy<IF, Allocator>>
-class vector;
+        static size_t align_class(size_t align) noexcept
+        {
+            return std::min(log2(align), top_class);
+        }
 
-template <typename CP, typename Constructible> struct CloningPolicyHolder : public CP {
-    CloningPolicyHolder()                           = default;
-    CloningPolicyHolder(const CloningPolicyHolder&) = default;
-    template <typename T> explicit CloningPolicyHolder(type_tag<T> /*unused*/) noexcept { }
-};
+        std::array<size_t, align_classes> padded;
+        std::array<size_t, align_classes> align_histogram;
+    };
 
-template <typename CP> struct CloningPolicyHolder<CP, std::true_type> : public CP {
-    CloningPolicyHolder()                           = default;
-    CloningPolicyHolder(const CloningPolicyHolder&) = default;
-    template <typename T>
-    explicit CloningPolicyHolder(type_tag<T> t) noexcept
-        : CP(t)
-    {
-    }
-};
+    template <> struct align_class_totals<false> {
+        void add_class(size_t /*size*/, size_t /*align*/) noexcept { }
+        void remove_class(size_t /*size*/, size_t /*align*/) noexcept { }
 
-template <class CloningPolicy, class AllocatorTraits>
-struct vector_elem_ptr : private CloningPolicyHolder<CloningPolicy,
-                             typename std::is_constructible<CloningPolicy,
-                                 type_tag<typename AllocatorTraits::value_type>>::type> {
-    using void_pointer  = typename AllocatorTraits::void_pointer;
-    using pointer       = typename AllocatorTraits::pointer;
-    using const_pointer = typename AllocatorTraits::const_pointer;
-    using value_type    = typename AllocatorTraits::value_type;
+        static size_t padded_total(size_t /*max_align*/, size_t bound) noexcept { return bound; }
+        static size_t natural_bound(size_t payload, size_t count, size_t top_align) noexcept
+        {
+            return count ? payload + count * (top_align - 1) : payload;
+        }
+    };
 
-    using base = CloningPolicyHolder<CloningPolicy,
-        typename std::is_constructible<CloningPolicy, type_tag<value_type>>::type>;
+    /// number of objects whose destructor has to be called, counted when the cloning policy
+    /// tells it per object
+    template <bool Counted> struct destructor_count {
+        destructor_count() noexcept
+            : nontrivial {}
+        {
+        }
 
-    template <typename T>
-    using forward_tag_t = typename std::is_constructible<CloningPolicy, T>::type;
+        void add_destructor(bool needed) noexcept { nontrivial += needed; }
+        void remove_destructor(bool needed) noexcept { nontrivial -= needed; }
+        bool no_destructors() const noexcept { return nontrivial == 0; }
 
-    template <typename T>
-    using forward_tag = typename std::conditional<forward_tag_t<T>::value, type_tag<T>, void>::type;
+        size_t nontrivial;
+    };
 
-    using size_descr_t = std::pair<size_t, size_t>;
-    using size_func_t  = size_descr_t();
-    using policy_t     = CloningPolicy;
-    vector_elem_ptr()
-        : ptr {}
-        , sf {}
-    {
-    }
+    template <> struct destructor_count<false> {
+        void add_destructor(bool /*needed*/) noexcept { }
+        void remove_destructor(bool /*needed*/) noexcept { }
+        static bool no_destructors() noexcept { return false; }
+    };
 
-    template <typename T,
-        typename = std::enable_if_t<std::is_base_of<value_type, std::decay_t<T>>::value>>
-    explicit vector_elem_ptr(type_tag<T> t, void_pointer s = nullptr, pointer i = nullptr) noexcept
-        : base(t)
-        , ptr { s, i }
-        , sf { vector_elem_ptr::size_func<std::decay_t<T>>() }
-    {
-    }
+    /// running totals of the objects stored in a vector, so that growth decisions and clear do
+    /// not need to walk the index; the totals per alignment class make the padded extent of the
+    /// objects exact, without them it is bounded from the payload
+    template <bool PerClass, bool CountDestructors>
+    struct storage_accounting : align_class_totals<PerClass>, destructor_count<CountDestructors> {
+        storage_accounting() noexcept
+            : payload {}
+            , count {}
+            , top_align {}
+        {
+        }
 
-    vector_elem_ptr(const vector_elem_ptr& other) noexcept
-        : base(other)
-        , ptr { other.ptr }
-        , sf { other.sf }
-    {
-    }
-    vector_elem_ptr& operator=(const vector_elem_ptr& rhs) noexcept
-    {
-        policy() = rhs.policy();
-        ptr      = rhs.ptr;
-        sf       = rhs.sf;
-        return *this;
-    }
-    void swap(vector_elem_ptr& rhs) noexcept
-    {
-        using std::swap;
-        swap(policy(), rhs.policy());
-        swap(ptr, rhs.ptr);
-        swap(sf, rhs.sf);
-    }
+        void add(size_t size, size_t align, bool trivially_destructible) noexcept
+        {
+            payload += size;
+            ++count;
+            top_align = std::max(top_align, align);
+            this->add_class(size, align);
+            this->add_destructor(!trivially_destructible);
+        }
 
-    policy_t&                                 policy() noexcept { return *this; }
-    const policy_t&                           policy() const noexcept { return *this; }
-    size_t                                    size() const noexcept { return sf.first; }
-    size_t                                    align() const noexcept { return sf.second; }
-    template <typename T> static size_descr_t size_func() { return { sizeof(T), alignof(T) }; }
-    ~vector_elem_ptr()
-    {
-        ptr.first = ptr.second = nullptr;
-        sf                     = size_descr_t { 0, 0 };
-    }
+        void remove(size_t size, size_t align, bool trivially_destructible) noexcept
+        {
+            payload -= size;
+            // the largest alignment is kept as an upper bound while there are objects
+            if (!--count) {
+                top_align = 0;
+            }
+            this->remove_class(size, align);
+            this->remove_destructor(!trivially_destructible);
+        }
 
-    std::pair<void_pointer, pointer> ptr;
+        /// storage taken by the objects when each of them is padded to max_align, exact for the
+        /// tracked classes and an upper bound otherwise
+        size_t padded_extent(size_t max_align) const noexcept
+        {
+            return this->padded_total(max_align, payload + count * (max_align - 1));
+        }
 
-private:
-    size_descr_t sf;
-};
+        /// upper bound of the storage taken by the objects when each of them is placed at its own
+        /// alignment right after the previous one
+        size_t natural_extent_bound() const noexcept
+        {
+            return this->natural_bound(payload, count, top_align);
+        }
 
-template <class C, class A>
-void swap(vector_elem_ptr<C, A>& lhs, vector_elem_ptr<C, A>& rhs) noexcept
-{
-    lhs.swap(rhs);
-}
+        /// whether none of the objects needs its destructor to be called, false when unknown
+        bool trivially_destructible() const noexcept { return !count || this->no_destructors(); }
 
-struct virtual_cloning_policy {
+        size_t payload;
+        size_t count;
+        size_t top_align;
+    };
 
-    template <typename Allocator, typename Pointer, typename VoidPointer>
-    Pointer clone(const Allocator& a, Pointer obj, VoidPointer dest) const
-    {
-        return obj->clone(a, dest);
-    }
+    /// storage freed between the objects of a vector, kept in free lists by size class; the
+    /// nodes of the lists are stored in the freed storage itself
+    template <class VoidPointer, class Pointer, bool Kept = true> struct free_holes {
+        static constexpr size_t size_classes = 6;
 
-    template <typename Allocator, typename Pointer, typename VoidPointer>
-    Pointer move(const Allocator& a, Pointer obj, VoidPointer dest) const noexcept(noexcept(
-        std::declval<Pointer>()->move(std::declval<Allocator>(), std::declval<VoidPointer>())))
-    {
-        return obj->move(a, dest);
-    }
-};
+        struct node {
+            VoidPointer next;
+            size_t      size;
+        };
 
-struct no_cloning_exception : public std::exception {
-    const char* what() const noexcept override { return "cloning attempt with no_cloning_policy"; }
-};
+        free_holes() noexcept
+            : heads {}
+        {
+        }
 
-struct no_cloning_policy {
-    template <typename Allocator, typename Pointer, typename VoidPointer>
-    Pointer clone(const Allocator& /* a */, Pointer /* obj */, VoidPointer /* dest */) const
-    {
-        throw no_cloning_exception {};
-    }
-};
+        /// records [first, last) as free, ranges too small to hold a node are not tracked
+        void add(VoidPointer first, VoidPointer last) noexcept
+        {
+            const auto f = align_up(static_cast<Pointer>(first), alignof(node));
+            const auto l = static_cast<Pointer>(last);
+            if (l <= f || size_t(l - f) < sizeof(node)) {
+                return;
+            }
+            auto& head = heads[size_class(size_t(l - f))];
+            ::new (static_cast<void*>(std::addressof(*f))) node { head, size_t(l - f) };
+            head = f;
+        }
 
-template <class Interface, class Allocator, typename Interface_Is_NoExcept_Movable>
-struct delegate_cloning_policy {
-    enum Operation { Clone, Move };
+        /// takes the best fitting hole of the size class of the object, or the first fitting
+        /// one of the bigger classes, and returns the storage of the object within it; the rest
+        /// of the hole stays free
+        VoidPointer take(size_t size, size_t align) noexcept
+        {
+            for (auto c = size_class(size); c < size_classes; ++c) {
+                VoidPointer* best = nullptr;
+                for (auto link = &heads[c]; *link; link = &node_at(*link).next) {
+                    if (fits(*link, size, align)
+                        && (!best || node_at(*link).size < node_at(*best).size)) {
+                        best = link;
+                    }
+                }
+                if (best) {
+                    const auto first = static_cast<Pointer>(*best);
+                    const auto hole  = node_at(first);
+                    const auto obj   = align_up(first, align);
+                    *best            = hole.next;
+                    add(first, obj);
+                    add(obj + size, first + hole.size);
+                    return obj;
+                }
+            }
+            return nullptr;
+        }
 
-    using clone_func_t     = Interface*(const Allocator& a, Interface* obj, void* dest, Operation);
-    using clone_func_ptr_t = clone_func_t*;
-    using noexcept_movable = Interface_Is_NoExcept_Movable;
-    using void_pointer     = typename std::allocator_traits<Allocator>::void_pointer;
-    using pointer          = typename std::allocator_traits<Allocator>::pointer;
-    using const_pointer    = typename std::allocator_traits<Allocator>::const_pointer;
-    using allocator_type   = Allocator;
+        /// drops the holes starting at or above p, before objects are moved over them
+        void forget_from(VoidPointer p) noexcept
+        {
+            forget_if([p](Pointer h) { return h >= static_cast<Pointer>(p); });
+        }
 
-    delegate_cloning_policy() noexcept
-        : cf {}
-    {
-    }
+        /// drops the holes starting in [first, last)
+        void forget(VoidPointer first, VoidPointer last) noexcept
+        {
+            forget_if([first, last](Pointer h) {
+                return h >= static_cast<Pointer>(first) && h < static_cast<Pointer>(last);
+            });
+        }
 
-    template <typename T,
+        void clear() noexcept { heads = {}; }
+
+        /// number and total size of the holes
+        std::pair<size_t, size_t> totals() const noexcept
+        {
+            std::pair<size_t, size_t> res {};
+            for (auto head : heads) {
+                for (; head; head = node_at(head).next) {
+                    ++res.first;
+                    res.second += node_at(head).size;
+                }
+            }
+            return res;
+        }
+
+        static size_t size_class(size_t size) noexcept
+        {
+            return std::min(log2(size / sizeof(node)), size_classes - 1);
+        }
+
+        std::array<VoidPointer, size_classes> heads;
+
+    private:
+        template <class Pred> void forget_if(Pred pred) noexcept
+        {
+            for (auto& head : heads) {
+                for (auto link = &head; *link;) {
+                    if (pred(static_cast<Pointer>(*link))) {
+                        *link = node_at(*link).next;
+                    } else {
+                        link = &node_at(*link).next;
+                    }
+                }
+            }
+        }
+
+        static Pointer align_up(Pointer p, size_t align) noexcept
+        {
+            const auto v = static_cast<size_t>(p - static_cast<Pointer>(nullptr));
+            return p + (((v + align - 1) / align) * align - v);
+        }
+
+        static bool fits(VoidPointer hole, size_t size, size_t align) noexcept
+        {
+            const auto first = static_cast<Pointer>(hole);
+            return align_up(first, align) + size <= first + node_at(hole).size;
+        }
+
+        static node& node_at(VoidPointer p) noexcept
+        {
+            const auto storage = std::addressof(*static_cast<Pointer>(p));
+            return *static_cast<node*>(static_cast<void*>(storage));
+        }
+    };
+
+    /// holes that are not kept: storage freed between the objects is only reclaimed when the
+    /// objects are moved
+    template <class VoidPointer, class Pointer> struct free_holes<VoidPointer, Pointer, false> {
+        void        add(VoidPointer, VoidPointer) noexcept {}
+        VoidPointer take(size_t, size_t) noexcept { return nullptr; }
+        void        forget_from(VoidPointer) noexcept {}
+        void        forget(VoidPointer, VoidPointer) noexcept {}
+        void        clear() noexcept {}
+        std::pair<size_t, size_t> totals() const noexcept { return {}; }
+    };
+
+    /// index of the element defragment continues from
+    template <bool Kept> struct defrag_cursor {
+        size_t position() const noexcept { return _pos; }
+        void   advance_to(size_t pos) noexcept { _pos = pos; }
+        void   reset() noexcept { _pos = 0; }
+
+    private:
+        size_t _pos = 0;
+    };
+
+    /// without a cursor defragment starts over from the first element on every call
+    template <> struct defrag_cursor<false> {
+        size_t position() const noexcept { return 0; }
+        void   advance_to(size_t) noexcept {}
+        void   reset() noexcept {}
+    };
+
+    template <class VoidPointer, class IsRelative> struct storage_base_holder {
+        storage_base_holder() noexcept
+            : _base {}
+        {
+        }
+        explicit storage_base_holder(VoidPointer b) noexcept
+            : _base { b }
+        {
+        }
+        VoidPointer storage_base() const noexcept { return _base; }
+
+    private:
+        VoidPointer _base;
+    };
+
+    template <class VoidPointer> struct storage_base_holder<VoidPointer, std::false_type> {
+        storage_base_holder() noexcept = default;
+        explicit storage_base_holder(VoidPointer /*unused*/) noexcept { }
+        VoidPointer storage_base() const noexcept { return nullptr; }
+    };
+
+    /// size and alignment of an object that is about to be constructed
+    struct object_layout {
+        constexpr size_t size() const noexcept { return s; }
+        constexpr size_t align() const noexcept { return a; }
+
+        size_t s;
+        size_t a;
+    };
+
+    /// max alignment and extent of one object of every type of Ts placed one after the other by
+    /// Packing, folded at compile time
+    template <class Packing, size_t MinAlign, class... Ts> struct static_layout {
+        static constexpr size_t align = std::max({ MinAlign, alignof(Ts)... });
+
+        static constexpr size_t extent() noexcept
+        {
+            using expand  = size_t[];
+            size_t offset = 0;
+            (void)expand { 0,
+                (offset = Packing::next_offset(offset, sizeof(Ts), alignof(Ts), align))... };
+            return offset;
+        }
+    };
+
+    template <class TT> struct has_descriptor {
+        template <class U>
+        static std::true_type  test(U&&, decltype(std::declval<const U&>().descriptor()->size)*);
+        static std::false_type test(...);
+        static constexpr bool  value
+            = std::is_same<std::true_type, decltype(test(std::declval<TT>(), nullptr))>::value;
+    };
+
+    /// 1 based position of T in Ts, 0 if T is not one of them
+    template <class T, class... Ts> struct type_index : std::integral_constant<size_t, 0> {
+    };
+    template <class T, class U, class... Ts>
+    struct type_index<T, U, Ts...>
+        : std::integral_constant<size_t,
+              std::is_same<T, U>::value
+                  ? 1
+                  : (type_index<T, Ts...>::value ? 1 + type_index<T, Ts...>::value : 0)> {
+    };
+
+    template <class TT> struct has_type_id {
+        template <class U>
+        static std::true_type  test(U&&, decltype(std::declval<const U&>().type_id())*);
+        static std::false_type test(...);
+        static constexpr bool  value
+            = std::is_same<std::true_type, decltype(test(std::declval<TT>(), nullptr))>::value;
+    };
+
+    /// size and alignment of an element, stored along with the element unless the cloning
+    /// policy refers to a per type descriptor that already has them
+    template <class Policy, bool HasDescriptor = has_descriptor<Policy>::value>
+    struct elem_size_info {
+        using size_descr_t = std::pair<size_t, size_t>;
+
+        elem_size_info() noexcept
+            : sf {}
+        {
+        }
+        template <typename T>
+        explicit elem_size_info(type_tag<T> /*unused*/) noexcept
+            : sf { sizeof(T), alignof(T) }
+        {
+        }
+        size_t size(const Policy& /*unused*/) const noexcept { return sf.first; }
+        size_t align(const Policy& /*unused*/) const noexcept { return sf.second; }
+
+    private:
+        size_descr_t sf;
+    };
+
+    template <class Policy> struct elem_size_info<Policy, true> {
+        elem_size_info() noexcept = default;
+        template <typename T> explicit elem_size_info(type_tag<T> /*unused*/) noexcept { }
+        size_t size(const Policy& p) const noexcept { return p.descriptor()->size; }
+        size_t align(const Policy& p) const noexcept { return p.descriptor()->align; }
+    };
+
+    template <class Descriptor, class T> struct descriptor_instance {
+        static constexpr Descriptor value = { sizeof(T), alignof(T),
+            &Descriptor::template clone_func<T>, &Descriptor::template move_func<T>,
+            &Descriptor::template destroy_func<T>, is_trivially_relocatable<T>::value,
+            is_trivially_destructible<T>::value, is_trivially_copyable<T>::value };
+    };
+
+    template <class Descriptor, class T>
+    constexpr Descriptor descriptor_instance<Descriptor, T>::value;
+
+    template <class Descriptor> struct descriptor_instance<Descriptor, void> {
+        static constexpr Descriptor value
+            = { 0, 1, nullptr, nullptr, nullptr, false, false, false };
+    };
+
+    template <class Descriptor> constexpr Descriptor descriptor_instance<Descriptor, void>::value;
+
+    template <class Policy, class Interface, class Allocator>
+    using is_cloning_policy = std::integral_constant<bool,
+        vector_impl::is_cloning_policy_impl<Policy, Interface, Allocator>::value>;
+
+    template <class Policy, class Interface, class Allocator> struct cloning_policy_traits {
+        static_assert(is_cloning_policy<Policy, Interface, Allocator>::value,
+            "policy is not a cloning policy");
+        using allocator_type   = Allocator;
+        using allocator_traits = std::allocator_traits<allocator_type>;
+        using pointer          = typename allocator_traits::pointer;
+        using void_pointer     = typename allocator_traits::void_pointer;
+
+        using policy_impl
+            = ::poly::vector_impl::is_cloning_policy_impl<Policy, Interface, allocator_type>;
+        using has_move_t       = typename policy_impl::has_move_t;
+        using noexcept_movable = std::integral_constant<bool,
+            vector_impl::is_noexcept_movable_t<Policy>::value && has_move_t::value>;
+        /// none of the elements needs its destructor to be called
+        using trivially_destructible_elements = is_trivially_destructible_policy_t<Policy>;
+
+        static pointer move(const Policy& p, const allocator_type& a, pointer obj,
+            void_pointer dest) noexcept(noexcept_movable::value)
+        {
+            return move_impl(p, a, obj, dest, typename policy_impl::has_move_t {});
+        }
+
+        static void destroy(const Policy& p, const allocator_type& a, pointer obj) noexcept
+        {
+            if (!trivially_destructible(p)) {
+                destroy_impl(p, a, obj, typename policy_impl::has_destroy_t {});
+            }
+        }
+
+        static bool trivially_destructible(const Policy& p) noexcept
+        {
+            return trivially_destructible_elements::value
+                || trivially_destructible_impl(
+                    p, std::integral_constant<bool, has_descriptor<Policy>::value> {});
+        }
+
+        static bool trivially_relocatable(const Policy& p) noexcept
+        {
+            return trivially_relocatable_impl(
+                p, std::integral_constant<bool, has_descriptor<Policy>::value> {});
+        }
+
+        static bool trivially_copyable(const Policy& p) noexcept
+        {
+            return is_trivially_copyable_policy_t<Policy>::value
+                || trivially_copyable_impl(
+                    p, std::integral_constant<bool, has_descriptor<Policy>::value> {});
+        }
+
+        /// whether obj is of type T, answered by the policy if it can identify the types
+        template <class T> static bool holds(const Policy& p, const Interface& obj) noexcept
+        {
+            return holds_impl<T>(
+                p, obj, std::integral_constant<bool, has_type_id<Policy>::value> {});
+        }
+
+        /// whether the two objects are of the same type, compared the same way as by holds
+        static bool same_type(const Policy& lp, const Interface& lhs, const Policy& rp,
+            const Interface& rhs) noexcept
+        {
+            return same_type_impl(
+                lp, lhs, rp, rhs, std::integral_constant<bool, has_type_id<Policy>::value> {});
+        }
+
+    private:
+        static pointer move_impl(const Policy& p, const allocator_type& a, pointer obj,
+            void_pointer dest, std::true_type /*unused*/) noexcept(noexcept_movable::value)
+        {
+            return p.move(a, obj, dest);
+        }
+        static pointer move_impl(const Policy& p, const allocator_type& a, pointer obj,
+            void_pointer dest, std::false_type /*unused*/)
+        {
+            return p.clone(a, obj, dest);
+        }
+        static void destroy_impl(const Policy& p, const allocator_type& a, pointer obj,
+            std::true_type /*unused*/) noexcept
+        {
+            p.destroy(a, obj);
+        }
+        static void destroy_impl(const Policy& /*unused*/, const allocator_type& a, pointer obj,
+            std::false_type /*unused*/) noexcept
+        {
+            allocator_type alloc(a);
+            allocator_traits::destroy(alloc, obj);
+        }
+        static bool trivially_relocatable_impl(const Policy& p, std::true_type /*unused*/) noexcept
+        {
+            return p.descriptor()->trivially_relocatable;
+        }
+        static bool trivially_relocatable_impl(
+            const Policy& /*unused*/, std::false_type /*unused*/) noexcept
+        {
+            return is_trivially_relocatable_policy_t<Policy>::value;
+        }
+        static bool trivially_copyable_impl(const Policy& p, std::true_type /*unused*/) noexcept
+        {
+            return p.descriptor()->trivially_copyable;
+        }
+        static bool trivially_copyable_impl(
+            const Policy& /*unused*/, std::false_type /*unused*/) noexcept
+        {
+            return false;
+        }
+        static bool trivially_destructible_impl(const Policy& p, std::true_type /*unused*/) noexcept
+        {
+            return p.descriptor()->trivially_destructible;
+        }
+        static bool trivially_destructible_impl(
+            const Policy& /*unused*/, std::false_type /*unused*/) noexcept
+        {
+            return false;
+        }
+        template <class T>
+        static bool holds_impl(
+            const Policy& p, const Interface& /*unused*/, std::true_type /*unused*/) noexcept
+        {
+            return p.type_id() == Policy::template type_id_of<T>();
+        }
+        template <class T>
+        static bool holds_impl(
+            const Policy& /*unused*/, const Interface& obj, std::false_type /*unused*/) noexcept
+        {
+            return typeid(obj) == typeid(T);
+        }
+        static bool same_type_impl(const Policy& lp, const Interface& /*unused*/,
+            const Policy& rp, const Interface& /*unused*/, std::true_type /*unused*/) noexcept
+        {
+            return lp.type_id() == rp.type_id();
+        }
+        static bool same_type_impl(const Policy& /*unused*/, const Interface& lhs,
+            const Policy& /*unused*/, const Interface& rhs, std::false_type /*unused*/) noexcept
+        {
+            return typeid(lhs) == typeid(rhs);
+        }
+    };
+
+} // namespace vector_impl
+
+template <class Interface, class Allocator = std::allocator<Interface>,
+    typename Interface_Is_NoExcept_Movable = std::true_type>
+struct delegate_cloning_policy;
+
+struct pointer_index;
+struct max_align_packing;
+struct single_allocation;
+struct basic_tracking;
+template <class Index = pointer_index, class Packing = max_align_packing,
+    class Storage = single_allocation, class Tracking = basic_tracking>
+struct vector_layout;
+
+template <class IF, class Allocator = std::allocator<IF>,
+    /// implicit noexcept_movability when using defaults of delegate cloning
+    /// policy
+    class CloningPolicy = delegate_cloning_policy<IF, Allocator>,
+    class Layout        = vector_layout<pointer_index>>
+class vector;
+
+template <typename CP, typename Constructible> struct CloningPolicyHolder : public CP {
+    CloningPolicyHolder()                           = default;
+    CloningPolicyHolder(const CloningPolicyHolder&) = default;
+    template <typename T> explicit CloningPolicyHolder(type_tag<T> /*unused*/) noexcept { }
+};
+
+template <typename CP> struct CloningPolicyHolder<CP, std::true_type> : public CP {
+    CloningPolicyHolder()                           = default;
+    CloningPolicyHolder(const CloningPolicyHolder&) = default;
+    template <typename T>
+    explicit CloningPolicyHolder(type_tag<T> t) noexcept
+        : CP(t)
+    {
+    }
+};
+
+template <class CloningPolicy, class AllocatorTraits>
+struct vector_elem_ptr : private CloningPolicyHolder<CloningPolicy,
+                             typename std::is_constructible<CloningPolicy,
+                                 type_tag<typename AllocatorTraits::value_type>>::type>,
+                         private vector_impl::elem_size_info<CloningPolicy> {
+    using void_pointer  = typename AllocatorTraits::void_pointer;
+    using pointer       = typename AllocatorTraits::pointer;
+    using const_pointer = typename AllocatorTraits::const_pointer;
+    using value_type    = typename AllocatorTraits::value_type;
+
+    using base = CloningPolicyHolder<CloningPolicy,
+        typename std::is_constructible<CloningPolicy, type_tag<value_type>>::type>;
+    using size_info = vector_impl::elem_size_info<CloningPolicy>;
+
+    template <typename T>
+    using forward_tag_t = typename std::is_constructible<CloningPolicy, T>::type;
+
+    template <typename T>
+    using forward_tag = typename std::conditional<forward_tag_t<T>::value, type_tag<T>, void>::type;
+
+    using policy_t    = CloningPolicy;
+    using is_relative = std::false_type;
+
+    static constexpr size_t max_storage_size = std::numeric_limits<size_t>::max();
+
+    vector_elem_ptr()
+        : ptr {}
+    {
+    }
+
+    template <typename T,
+        typename = std::enable_if_t<std::is_base_of<value_type, std::decay_t<T>>::value>>
+    explicit vector_elem_ptr(type_tag<T> t, void_pointer s = nullptr, pointer i = nullptr) noexcept
+        : base(t)
+        , size_info(type_tag<std::decay_t<T>> {})
+        , ptr { s, i }
+    {
+    }
+
+    vector_elem_ptr(const vector_elem_ptr& other) noexcept
+        : base(other)
+        , size_info(other)
+        , ptr { other.ptr }
+    {
+    }
+    vector_elem_ptr& operator=(const vector_elem_ptr& rhs) noexcept
+    {
+        policy() = rhs.policy();
+        sizes()  = rhs.sizes();
+        ptr      = rhs.ptr;
+        return *this;
+    }
+    void swap(vector_elem_ptr& rhs) noexcept
+    {
+        using std::swap;
+        swap(policy(), rhs.policy());
+        swap(sizes(), rhs.sizes());
+        swap(ptr, rhs.ptr);
+    }
+
+    policy_t&       policy() noexcept { return *this; }
+    const policy_t& policy() const noexcept { return *this; }
+    size_t          size() const noexcept { return sizes().size(policy()); }
+    size_t          align() const noexcept { return sizes().align(policy()); }
+
+    pointer      object(void_pointer /*base*/) const noexcept { return ptr.second; }
+    void_pointer storage(void_pointer /*base*/) const noexcept { return ptr.first; }
+    void         place(void_pointer /*base*/, void_pointer s, pointer i) noexcept
+    {
+        ptr = std::make_pair(s, i);
+    }
+    static constexpr bool representable(void_pointer /*s*/, pointer /*i*/) noexcept
+    {
+        return true;
+    }
+
+    std::pair<void_pointer, pointer> ptr;
+
+private:
+    size_info&       sizes() noexcept { return *this; }
+    const size_info& sizes() const noexcept { return *this; }
+};
+
+template <class C, class A>
+void swap(vector_elem_ptr<C, A>& lhs, vector_elem_ptr<C, A>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+/// Index entry that locates its object by a 32-bit offset relative to the object storage
+/// of the container instead of a pair of absolute pointers. The size, the alignment and the
+/// offset of the interface subobject within the object are packed into a second 32-bit word,
+/// so an entry takes 8 bytes on top of the cloning policy. Entries are position independent
+/// and trivially copyable whenever the cloning policy is, hence the index can be copied in
+/// bulk when the storage is reallocated.
+template <class CloningPolicy, class AllocatorTraits>
+struct compact_elem_ptr : private CloningPolicyHolder<CloningPolicy,
+                              typename std::is_constructible<CloningPolicy,
+                                  type_tag<typename AllocatorTraits::value_type>>::type> {
+    using void_pointer  = typename AllocatorTraits::void_pointer;
+    using pointer       = typename AllocatorTraits::pointer;
+    using const_pointer = typename AllocatorTraits::const_pointer;
+    using value_type    = typename AllocatorTraits::value_type;
+    using byte_pointer  = typename AllocatorTraits::template rebind_traits<uint8_t>::pointer;
+    using offset_type   = std::uint32_t;
+
+    using base = CloningPolicyHolder<CloningPolicy,
+        typename std::is_constructible<CloningPolicy, type_tag<value_type>>::type>;
+
+    using policy_t    = CloningPolicy;
+    using is_relative = std::true_type;
+
+    static constexpr offset_type align_bits      = 5;
+    static constexpr offset_type adjust_bits     = 7;
+    static constexpr offset_type size_shift      = align_bits + adjust_bits;
+    static constexpr size_t      max_object_size = (size_t(1) << (32 - size_shift)) - 1;
+    static constexpr size_t      max_adjustment  = (size_t(1) << adjust_bits) - 1;
+    static constexpr size_t max_storage_size = std::numeric_limits<offset_type>::max();
+
+    compact_elem_ptr() noexcept
+        : offset {}
+        , descr {}
+    {
+    }
+
+    template <typename T,
+        typename = std::enable_if_t<std::is_base_of<value_type, std::decay_t<T>>::value>>
+    explicit compact_elem_ptr(type_tag<T> t) noexcept
+        : base(t)
+        , offset {}
+        , descr { static_cast<offset_type>(vector_impl::log2(alignof(std::decay_t<T>))
+              | (sizeof(std::decay_t<T>) << size_shift)) }
+    {
+        static_assert(sizeof(std::decay_t<T>) <= max_object_size,
+            "type is too big to be stored with a compact index");
+    }
+
+    compact_elem_ptr(const compact_elem_ptr& other) = default;
+    compact_elem_ptr& operator=(const compact_elem_ptr& rhs) = default;
+
+    void swap(compact_elem_ptr& rhs) noexcept
+    {
+        using std::swap;
+        swap(policy(), rhs.policy());
+        swap(offset, rhs.offset);
+        swap(descr, rhs.descr);
+    }
+
+    policy_t&       policy() noexcept { return *this; }
+    const policy_t& policy() const noexcept { return *this; }
+    size_t          size() const noexcept { return descr >> size_shift; }
+    size_t align() const noexcept { return size_t(1) << (descr & ((1U << align_bits) - 1)); }
+
+    pointer object(void_pointer base) const noexcept
+    {
+        return static_cast<pointer>(
+            static_cast<void_pointer>(static_cast<byte_pointer>(base) + offset + adjustment()));
+    }
+    void_pointer storage(void_pointer base) const noexcept
+    {
+        return static_cast<byte_pointer>(base) + offset;
+    }
+    void place(void_pointer base, void_pointer s, pointer i) noexcept
+    {
+        assert(representable(s, i));
+        offset = static_cast<offset_type>(
+            static_cast<byte_pointer>(s) - static_cast<byte_pointer>(base));
+        descr = (descr & ~(offset_type(max_adjustment) << align_bits))
+            | static_cast<offset_type>(interface_adjustment(s, i) << align_bits);
+    }
+    /// the interface subobject must be located within max_adjustment bytes from the beginning
+    /// of the object, which holds for single inheritance hierarchies
+    static bool representable(void_pointer s, pointer i) noexcept
+    {
+        return interface_adjustment(s, i) <= max_adjustment;
+    }
+
+private:
+    static size_t interface_adjustment(void_pointer s, pointer i) noexcept
+    {
+        return static_cast<size_t>(
+            static_cast<byte_pointer>(static_cast<void_pointer>(i)) - static_cast<byte_pointer>(s));
+    }
+    size_t adjustment() const noexcept { return (descr >> align_bits) & max_adjustment; }
+
+    offset_type offset;
+    offset_type descr;
+};
+
+template <class C, class A>
+void swap(compact_elem_ptr<C, A>& lhs, compact_elem_ptr<C, A>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+/// index policy storing absolute pointers to the objects (default)
+struct pointer_index {
+    template <class CloningPolicy, class AllocatorTraits>
+    using elem_ptr = vector_elem_ptr<CloningPolicy, AllocatorTraits>;
+};
+
+/// index policy storing 32-bit offsets relative to the object storage, limits the object
+/// storage to 4GiB and the size of a single object to 1MiB
+struct compact_index {
+    template <class CloningPolicy, class AllocatorTraits>
+    using elem_ptr = compact_elem_ptr<CloningPolicy, AllocatorTraits>;
+};
+
+/// packing policy placing every object at the maximal alignment of the container and padding
+/// its storage to a multiple of it (default)
+struct max_align_packing {
+    using pads_to_max_align = std::true_type;
+
+    static constexpr size_t placement_align(size_t /*align*/, size_t max_align) noexcept
+    {
+        return max_align;
+    }
+    static constexpr size_t next_offset(
+        size_t offset, size_t size, size_t /*align*/, size_t max_align) noexcept
+    {
+        return offset + ((size + max_align - 1) / max_align) * max_align;
+    }
+    static constexpr size_t appended_size(size_t size, size_t /*align*/, size_t max_align) noexcept
+    {
+        return ((size + max_align - 1) / max_align) * max_align;
+    }
+};
+
+/// packing policy placing every object at its own alignment, a few over-aligned objects do not
+/// inflate the storage occupied by the rest of the elements
+struct natural_packing {
+    using pads_to_max_align = std::false_type;
+
+    static constexpr size_t placement_align(size_t align, size_t /*max_align*/) noexcept
+    {
+        return align;
+    }
+    static constexpr size_t next_offset(
+        size_t offset, size_t size, size_t align, size_t /*max_align*/) noexcept
+    {
+        return ((offset + align - 1) / align) * align + size;
+    }
+    /// the end of the existing objects is only estimated, hence the worst case padding
+    static constexpr size_t appended_size(size_t size, size_t align, size_t /*max_align*/) noexcept
+    {
+        return size + align - 1;
+    }
+};
+
+/// storage policy keeping the index and the objects in a single allocation (default)
+struct single_allocation {
+    using separate_index = std::false_type;
+};
+
+/// storage policy allocating the index separately from the objects, so running out of index
+/// entries or object storage only reallocates the one that ran out
+struct split_allocation {
+    using separate_index = std::true_type;
+};
+
+/// tracking policy keeping only the payload, the number and the largest alignment of the
+/// objects (default): sizing the storage of max_align_packing walks the index when it reallocates
+struct basic_tracking {
+    using per_align_class = std::false_type;
+    using free_lists      = std::false_type;
+    using defrag_cursor   = std::false_type;
+};
+
+/// tracking policy also keeping the padded totals of the objects per alignment class, so the
+/// storage is sized without walking the index, the holes left by removal in free lists, so new
+/// objects reuse them before the storage grows, and the element defragment stopped at
+struct full_tracking {
+    using per_align_class = std::true_type;
+    using free_lists      = std::true_type;
+    using defrag_cursor   = std::true_type;
+};
+
+template <class Index, class Packing, class Storage, class Tracking> struct vector_layout {
+    using index    = Index;
+    using packing  = Packing;
+    using storage  = Storage;
+    using tracking = Tracking;
+};
+
+struct virtual_cloning_policy {
+
+    template <typename Allocator, typename Pointer, typename VoidPointer>
+    Pointer clone(const Allocator& a, Pointer obj, VoidPointer dest) const
+    {
+        return obj->clone(a, dest);
+    }
+
+    template <typename Allocator, typename Pointer, typename VoidPointer>
+    Pointer move(const Allocator& a, Pointer obj, VoidPointer dest) const noexcept(noexcept(
+        std::declval<Pointer>()->move(std::declval<Allocator>(), std::declval<VoidPointer>())))
+    {
+        return obj->move(a, dest);
+    }
+};
+
+struct no_cloning_exception : public std::exception {
+    const char* what() const noexcept override { return "cloning attempt with no_cloning_policy"; }
+};
+
+struct no_cloning_policy {
+    template <typename Allocator, typename Pointer, typename VoidPointer>
+    Pointer clone(const Allocator& /* a */, Pointer /* obj */, VoidPointer /* dest */) const
+    {
+        throw no_cloning_exception {};
+    }
+};
+
+template <class Interface, class Allocator, typename Interface_Is_NoExcept_Movable>
+struct delegate_cloning_policy {
+    enum Operation { Clone, Move };
+
+    using clone_func_t     = Interface*(const Allocator& a, Interface* obj, void* dest, Operation);
+    using clone_func_ptr_t = clone_func_t*;
+    using noexcept_movable = Interface_Is_NoExcept_Movable;
+    using void_pointer     = typename std::allocator_traits<Allocator>::void_pointer;
+    using pointer          = typename std::allocator_traits<Allocator>::pointer;
+    using const_pointer    = typename std::allocator_traits<Allocator>::const_pointer;
+    using allocator_type   = Allocator;
+
+    delegate_cloning_policy() noexcept
+        : cf {}
+    {
+    }
+
+    template <typename T,
         typename = std::enable_if_t<!std::is_same<delegate_cloning_policy, std::decay_t<T>>::value>>
     explicit delegate_cloning_policy(type_tag<T> /*unused*/) noexcept
         : cf(&delegate_cloning_policy::clone_func<std::decay_t<T>>)
@@ -498,10 +1382,7 @@ struct delegate_cloning_policy {
             "delegate cloning policy requires noexcept move constructor");
     }
 
-    delegate_cloning_policy(const delegate_cloning_policy& other) noexcept
-        : cf { other.cf }
-    {
-    }
+    delegate_cloning_policy(const delegate_cloning_policy& other) noexcept = default;
 
     delegate_cloning_policy& operator=(const delegate_cloning_policy& other) noexcept = default;
 
@@ -533,14 +1414,200 @@ struct delegate_cloning_policy {
     {
         return cf(a, obj, dest, Move);
     }
+
+    /// the clone function is instantiated once per type, so it identifies the type
+    clone_func_ptr_t type_id() const noexcept { return cf; }
+    template <class T> static clone_func_ptr_t type_id_of() noexcept
+    {
+        return &delegate_cloning_policy::clone_func<T>;
+    }
     /////////////////////////
 private:
     clone_func_ptr_t cf;
 };
 
+/// Per type information shared by all the elements of the same concrete type. There is exactly
+/// one descriptor for every type, thus its address identifies the type of an element.
+template <class Interface, class Allocator> struct type_descriptor {
+    using pointer        = typename std::allocator_traits<Allocator>::pointer;
+    using void_pointer   = typename std::allocator_traits<Allocator>::void_pointer;
+    using clone_func_t   = pointer(const Allocator& a, pointer obj, void_pointer dest);
+    using destroy_func_t = void(const Allocator& a, pointer obj);
+
+    size_t          size;
+    size_t          align;
+    clone_func_t*   clone;
+    clone_func_t*   move;
+    destroy_func_t* destroy;
+    bool            trivially_relocatable;
+    bool            trivially_destructible;
+    bool            trivially_copyable;
+
+    const void* type_id() const noexcept { return this; }
+
+    template <class T> static pointer clone_func(const Allocator& a, pointer obj, void_pointer dest)
+    {
+        using traits = typename std::allocator_traits<Allocator>::template rebind_traits<T>;
+        typename traits::allocator_type alloc(a);
+        traits::construct(alloc, static_cast<typename traits::pointer>(dest),
+            *static_cast<typename traits::const_pointer>(obj));
+        return static_cast<typename traits::pointer>(dest);
+    }
+
+    template <class T> static pointer move_func(const Allocator& a, pointer obj, void_pointer dest)
+    {
+        using traits = typename std::allocator_traits<Allocator>::template rebind_traits<T>;
+        typename traits::allocator_type alloc(a);
+        traits::construct(alloc, static_cast<typename traits::pointer>(dest),
+            std::move(*static_cast<typename traits::pointer>(obj)));
+        return static_cast<typename traits::pointer>(dest);
+    }
+
+    template <class T> static void destroy_func(const Allocator& a, pointer obj)
+    {
+        using traits = typename std::allocator_traits<Allocator>::template rebind_traits<T>;
+        typename traits::allocator_type alloc(a);
+        traits::destroy(alloc, static_cast<typename traits::pointer>(obj));
+    }
+};
+
+/// Cloning policy referring to the static type_descriptor of the element's type, so an index
+/// entry holds a single pointer instead of a function pointer and a size/alignment pair.
+template <class Interface, class Allocator = std::allocator<Interface>,
+    typename Interface_Is_NoExcept_Movable = std::true_type>
+struct descriptor_cloning_policy {
+    using descriptor_type  = type_descriptor<Interface, Allocator>;
+    using noexcept_movable = Interface_Is_NoExcept_Movable;
+    using void_pointer     = typename std::allocator_traits<Allocator>::void_pointer;
+    using pointer          = typename std::allocator_traits<Allocator>::pointer;
+    using allocator_type   = Allocator;
+
+    descriptor_cloning_policy() noexcept
+        : descr { &vector_impl::descriptor_instance<descriptor_type, void>::value }
+    {
+    }
+
+    template <typename T,
+        typename
+        = std::enable_if_t<!std::is_same<descriptor_cloning_policy, std::decay_t<T>>::value>>
+    explicit descriptor_cloning_policy(type_tag<T> /*unused*/) noexcept
+        : descr { &vector_impl::descriptor_instance<descriptor_type, std::decay_t<T>>::value }
+    {
+        static_assert(
+            !noexcept_movable::value || std::is_nothrow_move_constructible<std::decay_t<T>>::value,
+            "descriptor cloning policy requires noexcept move constructor");
+    }
+
+    descriptor_cloning_policy(const descriptor_cloning_policy& other) noexcept = default;
+
+    descriptor_cloning_policy& operator=(const descriptor_cloning_policy& other) noexcept = default;
+
+    pointer clone(const Allocator& a, pointer obj, void_pointer dest) const
+    {
+        return descr->clone(a, obj, dest);
+    }
+
+    pointer move(const Allocator& a, pointer obj, void_pointer dest) const
+        noexcept(noexcept_movable::value)
+    {
+        return descr->move(a, obj, dest);
+    }
+
+    void destroy(const Allocator& a, pointer obj) const noexcept { descr->destroy(a, obj); }
+
+    const descriptor_type* descriptor() const noexcept { return descr; }
+    const void*            type_id() const noexcept { return descr->type_id(); }
+    template <class T> static const void* type_id_of() noexcept
+    {
+        return vector_impl::descriptor_instance<descriptor_type, T>::value.type_id();
+    }
+    /////////////////////////
+private:
+    const descriptor_type* descr;
+};
+
+/// Cloning policy for a closed set of types: an element only stores the 1 byte index of its
+/// type in Ts, which selects the type_descriptor of the type from a static table.
+template <class Interface, class Allocator, class... Ts> struct basic_variant_cloning_policy {
+    using descriptor_type  = type_descriptor<Interface, Allocator>;
+    using noexcept_movable = vector_impl::and_type_t<
+        typename std::is_nothrow_move_constructible<Ts>::type...>;
+    using trivially_destructible
+        = vector_impl::and_type_t<typename is_trivially_destructible<Ts>::type...>;
+    using trivially_copyable
+        = vector_impl::and_type_t<typename is_trivially_copyable<Ts>::type...>;
+    using index_type       = uint8_t;
+    using void_pointer     = typename std::allocator_traits<Allocator>::void_pointer;
+    using pointer          = typename std::allocator_traits<Allocator>::pointer;
+    using allocator_type   = Allocator;
+
+    static_assert(sizeof...(Ts) < std::numeric_limits<index_type>::max(),
+        "too many types for a 1 byte type index");
+
+    basic_variant_cloning_policy() noexcept
+        : index {}
+    {
+    }
+
+    template <typename T,
+        typename = std::enable_if_t<
+            !std::is_same<basic_variant_cloning_policy, std::decay_t<T>>::value>>
+    explicit basic_variant_cloning_policy(type_tag<T> /*unused*/) noexcept
+        : index { type_id_of<std::decay_t<T>>() }
+    {
+        static_assert(vector_impl::type_index<std::decay_t<T>, Ts...>::value != 0,
+            "type is not one of the variant types");
+    }
+
+    basic_variant_cloning_policy(const basic_variant_cloning_policy& other) noexcept = default;
+
+    basic_variant_cloning_policy& operator=(
+        const basic_variant_cloning_policy& other) noexcept = default;
+
+    pointer clone(const Allocator& a, pointer obj, void_pointer dest) const
+    {
+        return descriptor()->clone(a, obj, dest);
+    }
+
+    pointer move(const Allocator& a, pointer obj, void_pointer dest) const
+        noexcept(noexcept_movable::value)
+    {
+        return descriptor()->move(a, obj, dest);
+    }
+
+    void destroy(const Allocator& a, pointer obj) const noexcept { descriptor()->destroy(a, obj); }
+
+    const descriptor_type* descriptor() const noexcept { return descriptors[index]; }
+    index_type             type_id() const noexcept { return index; }
+    /// 1 based position of T in Ts, 0 if T is not one of them
+    template <class T> static constexpr index_type type_id_of() noexcept
+    {
+        return static_cast<index_type>(vector_impl::type_index<T, Ts...>::value);
+    }
+    /////////////////////////
+private:
+    static constexpr const descriptor_type* descriptors[] = {
+        &vector_impl::descriptor_instance<descriptor_type, void>::value,
+        &vector_impl::descriptor_instance<descriptor_type, Ts>::value...
+    };
+
+    index_type index;
+};
+
+template <class Interface, class Allocator, class... Ts>
+constexpr const typename basic_variant_cloning_policy<Interface, Allocator, Ts...>::descriptor_type*
+    basic_variant_cloning_policy<Interface, Allocator, Ts...>::descriptors[];
+
+template <class Interface, class... Ts>
+using variant_cloning_policy
+    = basic_variant_cloning_policy<Interface, std::allocator<Interface>, Ts...>;
+
 template <class ElemPtrT>
-class vector_iterator : public std::iterator<std::random_access_iterator_tag,
-                            typename std::remove_const_t<ElemPtrT>::value_type> {
+class vector_iterator
+    : public std::iterator<std::random_access_iterator_tag,
+          typename std::remove_const_t<ElemPtrT>::value_type>,
+      private vector_impl::storage_base_holder<typename std::remove_const_t<ElemPtrT>::void_pointer,
+          typename std::remove_const_t<ElemPtrT>::is_relative> {
 public:
     using p_elem         = std::remove_const_t<ElemPtrT>;
     using interface_type = typename p_elem::value_type;
@@ -552,13 +1619,17 @@ public:
     using difference_type = typename std::pointer_traits<elem_ptr>::difference_type;
     using reference       = std::add_lvalue_reference_t<interface_type>;
     using const_reference = std::add_lvalue_reference_t<std::add_const_t<interface_type>>;
+    using void_pointer    = typename p_elem::void_pointer;
+    using storage_base_holder
+        = vector_impl::storage_base_holder<void_pointer, typename p_elem::is_relative>;
 
     vector_iterator()
         : curr {}
     {
     }
-    explicit vector_iterator(elem_ptr p)
-        : curr { p }
+    explicit vector_iterator(elem_ptr p, void_pointer base = nullptr)
+        : storage_base_holder(base)
+        , curr { p }
     {
     }
 
@@ -566,7 +1637,8 @@ public:
         typename = std::enable_if_t<std::is_same<p_elem, T>::value
             && !std::is_same<vector_iterator, vector_iterator<T>>::value>>
     vector_iterator(const vector_iterator<T>& other)
-        : curr { other.get() }
+        : storage_base_holder(other.storage_base())
+        , curr { other.get() }
     {
     }
 
@@ -580,13 +1652,14 @@ public:
     void swap(vector_iterator& rhs)
     {
         using std::swap;
+        swap(static_cast<storage_base_holder&>(*this), static_cast<storage_base_holder&>(rhs));
         swap(curr, rhs.curr);
     }
 
-    pointer         operator->() noexcept { return curr->ptr.second; }
-    reference       operator*() noexcept { return *curr->ptr.second; }
-    const_pointer   operator->() const noexcept { return curr->ptr.second; }
-    const_reference operator*() const noexcept { return *curr->ptr.second; }
+    pointer         operator->() noexcept { return curr->object(storage_base()); }
+    reference       operator*() noexcept { return *curr->object(storage_base()); }
+    const_pointer   operator->() const noexcept { return curr->object(storage_base()); }
+    const_reference operator*() const noexcept { return *curr->object(storage_base()); }
 
     vector_iterator& operator++() noexcept
     {
@@ -621,8 +1694,11 @@ public:
         return *this;
     }
     difference_type operator-(vector_iterator rhs) const { return curr - rhs.curr; }
-    reference       operator[](difference_type n) { return *(curr[n].ptr.second); }
-    const_reference operator[](difference_type n) const { return *(curr[n].ptr.second); }
+    reference       operator[](difference_type n) { return *(curr[n].object(storage_base())); }
+    const_reference operator[](difference_type n) const
+    {
+        return *(curr[n].object(storage_base()));
+    }
     bool operator==(const vector_iterator& rhs) const noexcept { return curr == rhs.curr; }
     bool operator!=(const vector_iterator& rhs) const noexcept { return curr != rhs.curr; }
     bool operator<(const vector_iterator& rhs) const noexcept { return curr < rhs.curr; }
@@ -631,6 +1707,7 @@ public:
     bool operator>=(const vector_iterator& rhs) const noexcept { return curr >= rhs.curr; }
 
     elem_ptr get() const noexcept { return curr; }
+    using storage_base_holder::storage_base;
 
 private:
     elem_ptr curr;
@@ -659,9 +1736,11 @@ vector_iterator<ElemPtrT> operator-(
     return i -= n;
 }
 
-template <class IF, class Allocator, class CloningPolicy>
-class vector : private vector_impl::allocator_base<
-                   typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>> {
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+class vector
+    : private vector_impl::allocator_base<
+          typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>>,
+      private vector_impl::index_block<Allocator, typename Layout::storage::separate_index> {
 public:
     ///////////////////////////////////////////////
     // Member types
@@ -692,7 +1771,14 @@ public:
     using const_void_pointer        = typename my_base::const_void_pointer;
     using size_type                 = std::size_t;
     using cloning_policy            = CloningPolicy;
-    using elem_ptr                  = vector_elem_ptr<cloning_policy, interface_allocator_traits>;
+    using layout_type               = Layout;
+    using index_policy              = typename layout_type::index;
+    using packing_policy            = typename layout_type::packing;
+    using storage_policy            = typename layout_type::storage;
+    using separate_index            = typename storage_policy::separate_index;
+    using tracking_policy           = typename layout_type::tracking;
+    using elem_ptr =
+        typename index_policy::template elem_ptr<cloning_policy, interface_allocator_traits>;
     using iterator                  = vector_iterator<elem_ptr>;
     using const_iterator            = vector_iterator<elem_ptr const>;
     using reverse_iterator          = std::reverse_iterator<iterator>;
@@ -700,6 +1786,8 @@ public:
     using cloning_policy_traits = vector_impl::cloning_policy_traits<CloningPolicy, interface_type,
         interface_allocator_type>;
     using interface_type_noexcept_movable = typename cloning_policy_traits::noexcept_movable;
+    using trivially_destructible_elements =
+        typename cloning_policy_traits::trivially_destructible_elements;
 
     static_assert(std::is_same<IF, interface_type>::value,
         "interface type must be a non-cv qualified user defined type");
@@ -722,8 +1810,12 @@ public:
 
     vector& operator=(const vector& rhs);
     vector& operator=(vector&& rhs) noexcept;
-    // TODO: implement construcor, where all T :< IF
-    // explicit vector(T&&...);
+    /// constructs the objects in storage sized exactly for them with a single allocation
+    template <typename... T,
+        typename = std::enable_if_t<sizeof...(T) != 0
+            && vector_impl::and_type_t<
+                typename std::is_base_of<IF, std::decay_t<T>>::type...>::value>>
+    explicit vector(T&&... objs);
     ///////////////////////////////////////////////
     // Modifiers
     ///////////////////////////////////////////////
@@ -739,17 +1831,54 @@ public:
     void clear() noexcept;
     void swap(vector& x) noexcept;
 
-    // TODO(fecja): insert, erase,emplace, emplace_back, assign?
+    // TODO(fecja): emplace
     template <class descendant_type>
     std::enable_if_t<std::is_base_of<interface_type, std::decay_t<descendant_type>>::value,
         iterator>
     insert(const_iterator position, descendant_type&& val);
-    // template <class InputIterator>
-    // iterator insert (const_iterator position, InputIterator first,
-    // InputIterator last); iterator insert (const_iterator position,
-    // polyvectoriterator first, polyvectoriterator last);
+    /// the range must not be part of this container, if reallocation is needed the storage is
+    /// sized exactly for the result
+    iterator insert(const_iterator position, const_iterator first, const_iterator last);
+    void     append(const_iterator first, const_iterator last);
+    void     assign(const_iterator first, const_iterator last);
+    /// constructs one object of every type from the corresponding tuple of arguments, with at
+    /// most one allocation sized exactly for them; either every object is added or none
+    template <typename... T, typename... Tuples> void emplace_back_all(Tuples&&... args);
     iterator erase(const_iterator position);
     iterator erase(const_iterator first, const_iterator last);
+    /// replaces the element with the last one, whose object is moved into the freed storage if it
+    /// fits there and can be moved without throwing
+    iterator erase_unordered(const_iterator position) noexcept;
+    /// removes the elements satisfying pred in a single pass, moving every remaining object at
+    /// most once, and returns the number of removed elements
+    template <class Pred> size_type remove_if(Pred pred);
+    /// moves at most max_bytes of objects toward the front of the storage in index order and
+    /// returns the number of bytes moved; objects overlapping their destination that are not
+    /// trivially relocatable are moved through the free storage and count twice. The storage
+    /// freed by a completed pass is given back to the end of the storage
+    size_type defragment(size_type max_bytes);
+    /// sorts the elements by permuting their index entries, the objects are not moved
+    template <class Compare> void sort(Compare comp);
+    template <class Compare> void stable_sort(Compare comp);
+    /// moves the objects into index order without holes between them, e.g. after sorting, so
+    /// that iteration reads the storage sequentially again
+    void relayout();
+    /// makes the elements of the same type adjacent by permuting their index entries, the types
+    /// follow the order of their first element and the order within a type is kept
+    void stable_partition_by_type();
+    /// same as stable_partition_by_type followed by relayout, so iterating the vector calls the
+    /// functions of one type after the other
+    void group_by_type();
+    ///////////////////////////////////////////////
+    // Visitation
+    ///////////////////////////////////////////////
+    /// calls f with every element as its concrete type if that is one of Ts, and as the interface
+    /// otherwise; the type is identified by the cloning policy if it can, by typeid if not
+    template <typename... Ts, class F> void visit(F&& f);
+    template <typename... Ts, class F> void visit(F&& f) const;
+    /// same as visit, named after bucketed_vector::for_each_as
+    template <typename... Ts, class F> void for_each_as(F&& f);
+    template <typename... Ts, class F> void for_each_as(F&& f) const;
     ///////////////////////////////////////////////
     // Iterators
     ///////////////////////////////////////////////
@@ -773,10 +1902,17 @@ public:
     bool                      empty() const noexcept;
     size_type                 max_size() const noexcept;
     size_type                 max_align() const noexcept;
+    /// storage freed by erasing objects, which new objects fill before the storage grows
+    fragmentation_info        fragmentation() const noexcept;
     void reserve(size_type n, size_type avg_size, size_type max_align = alignof(std::max_align_t));
     void reserve(size_type n);
     void reserve(std::pair<size_t, size_t> s);
-    // TODO(fecjanky): void shrink_to_fit();
+    /// reserves for the given number of objects of every type on top of the current elements,
+    /// so adding them in any order does not reallocate
+    template <typename... T, typename... Counts> void reserve_for(Counts... counts);
+    template <class InputIt> void reserve_for(InputIt first, InputIt last);
+    void reserve_for(std::initializer_list<object_count> counts);
+    void shrink_to_fit();
     ///////////////////////////////////////////////
     // Element access
     ///////////////////////////////////////////////
@@ -802,55 +1938,140 @@ private:
     using elem_ptr_pointer = typename allocator_traits::template rebind_traits<elem_ptr>::pointer;
     using elem_ptr_const_pointer =
         typename allocator_traits::template rebind_traits<elem_ptr>::const_pointer;
-    using poly_copy_descr = std::tuple<elem_ptr_pointer, elem_ptr_pointer, void_pointer>;
+    using poly_copy_descr = std::tuple<elem_ptr_pointer, void_pointer, void_pointer>;
+    using free_holes      = vector_impl::free_holes<void_pointer, pointer,
+        tracking_policy::free_lists::value>;
+    using defrag_cursor = vector_impl::defrag_cursor<tracking_policy::defrag_cursor::value>;
+    /// the destructors are only counted when the cloning policy tells them apart per object
+    using storage_accounting = vector_impl::storage_accounting<
+        tracking_policy::per_align_class::value,
+        vector_impl::has_descriptor<CloningPolicy>::value
+            && !trivially_destructible_elements::value>;
 
     ////////////////////////
     /// Storage management helpers
     ////////////////////////
     static void_pointer       next_aligned_storage(void_pointer p, size_t align) noexcept;
+    static size_t             misalignment(void_pointer p, size_t align) noexcept;
     static size_t             storage_size(const_void_pointer b, const_void_pointer e) noexcept;
+    static void               check_storage_size(size_t n);
     std::pair<size_t, size_t> calculate_storage_size(
         size_t new_size, size_t new_elem_size, size_t new_alignment) const noexcept;
-    size_type occupied_storage(elem_ptr_const_pointer p) const noexcept;
+    size_t storage_extent(size_t max_alignment) const noexcept;
+    template <class InputIt>
+    static size_t storage_extent(
+        InputIt first, InputIt last, size_t offset, size_t max_alignment) noexcept;
+    template <class InputIt>
+    std::pair<size_t, size_t> range_storage_size(InputIt first, InputIt last) const noexcept;
+    template <class InputIt> bool can_append_range(InputIt first, InputIt last) const noexcept;
+    template <class InputIt> void make_room_for_range(InputIt first, InputIt last);
+    void append_range(elem_ptr_const_pointer first, elem_ptr_const_pointer last, void_pointer base);
+    void rollback_append(elem_ptr_pointer end, void_pointer free, bool ordered) noexcept;
+    template <class Ref, class F> static void visit_elem(const elem_ptr& e, Ref obj, F& f);
+    template <class Ref, class F, typename T, typename... Ts>
+    static void visit_elem(
+        const elem_ptr& e, Ref obj, F& f, type_tag<T> /*unused*/, type_tag<Ts>... ts);
+    template <class T, class Tuple, size_t... I>
+    void emplace_back_from_tuple(Tuple&& args, std::index_sequence<I...> /*unused*/);
+    size_t storage_extent_estimate(size_t max_alignment) const noexcept;
+    size_t storage_extent_estimate(size_t max_alignment, std::true_type /*unused*/) const noexcept;
+    size_t storage_extent_estimate(size_t max_alignment, std::false_type /*unused*/) const noexcept;
+    void   account(elem_ptr_const_pointer first, elem_ptr_const_pointer last) noexcept;
+    size_t placement_align(size_t align) const noexcept;
 
     template <typename CopyOrMove>
     void increase_storage(
         size_t desired_size, size_t curr_elem_size, size_t align, CopyOrMove /*unused*/);
 
-    void obtain_storage(my_base&& a, size_t n, size_t max_align, std::true_type /*unused*/);
-
-    void obtain_storage(
-        my_base&& a, size_t n, size_t max_align, std::false_type /*unused*/) noexcept;
+    template <typename CopyOrMove>
+    void obtain_storage(my_base&& a, size_t n, size_t max_align, CopyOrMove /*unused*/);
+    void obtain_storage(my_base&& a, size_t n, size_t max_align, std::true_type /*unused*/,
+        std::false_type /*unused*/);
+    void obtain_storage(my_base&& a, size_t n, size_t max_align, std::false_type /*unused*/,
+        std::false_type /*unused*/) noexcept;
+    void obtain_storage(my_base&& a, size_t n, size_t max_align, std::true_type /*unused*/,
+        std::true_type /*unused*/);
+    void obtain_storage(my_base&& a, size_t n, size_t max_align, std::false_type /*unused*/,
+        std::true_type /*unused*/);
 
     void init_layout(size_t storage_size, size_t capacity, size_t align_max = default_alignement);
+    /// allocates the storage for one object of every type of T, sized at compile time
+    template <typename... T> void init_layout_for();
 
     my_base&                              base() noexcept;
     const my_base&                        base() const noexcept;
-    static poly_copy_descr                poly_uninitialized_copy(my_base& a, void_pointer dst_ptr,
-                       elem_ptr_const_pointer begin, elem_ptr_const_pointer _free, elem_ptr_const_pointer end,
-                       size_t max_align);
-    static poly_copy_descr                poly_uninitialized_move(my_base& a, void_pointer dst_ptr,
-                       elem_ptr_const_pointer begin, elem_ptr_const_pointer _free, elem_ptr_const_pointer end,
-                       size_t max_align) noexcept;
+    poly_copy_descr poly_uninitialized_copy(my_base& a, elem_ptr_pointer dst_begin,
+        void_pointer storage_begin, elem_ptr_const_pointer _free, size_t capacity,
+        size_t max_align) const;
+    poly_copy_descr poly_uninitialized_relocate(my_base& a, elem_ptr_pointer dst_begin,
+        void_pointer storage_begin, elem_ptr_const_pointer _free, size_t capacity,
+        size_t max_align) noexcept;
+    bool            trivially_relocatable(elem_ptr_const_pointer p) const noexcept;
+    bool            trivially_copyable(elem_ptr_const_pointer p) const noexcept;
+    static interface_pointer rebased_object(
+        const elem_ptr& e, void_pointer base, void_pointer new_storage) noexcept;
+    static void relocate_bytes(void_pointer dst, void_pointer first, void_pointer last) noexcept;
+    static void copy_bytes(void_pointer dst, void_pointer first, void_pointer last) noexcept;
+    void        relocate_object(elem_ptr_pointer p, void_pointer dst);
+    bool        evacuate_overlapping(
+        elem_ptr_const_pointer p, void_pointer dst, size_type max_bytes, size_type& moved);
+    bool storage_in_index_order() const noexcept;
+    template <class Compare> auto index_compare(Compare& comp) const noexcept;
+    bool can_keep_offsets(void_pointer dst_base, const_void_pointer dst_end,
+        elem_ptr_const_pointer _free, size_t max_align) const noexcept;
     vector&                               copy_assign_impl(const vector& rhs);
+    vector&                               copy_assign_in_place(const vector& rhs);
+    bool                                  can_hold_copy_of(const vector& rhs) const noexcept;
+    size_t                                copy_storage_size() const noexcept;
     vector&                               move_assign_impl(vector&& rhs) noexcept;
     void                                  tidy() noexcept;
+    void                                  destroy_index_entries() noexcept;
     void                                  destroy_elem(elem_ptr_pointer p) noexcept;
     std::pair<void_pointer, void_pointer> destroy_range(
         elem_ptr_pointer first, elem_ptr_pointer last) noexcept;
     iterator erase_internal_range(elem_ptr_pointer first, elem_ptr_pointer last);
     iterator clear_till_end(elem_ptr_pointer first) noexcept;
-    void     init_ptrs(size_t cap) noexcept;
+    void     init_ptrs(size_t cap);
+    void     init_ptrs(size_t cap, std::false_type /*unused*/) noexcept;
+    void     init_ptrs(size_t cap, std::true_type /*unused*/);
+    static size_t    index_bytes(size_t n) noexcept;
+    elem_ptr_pointer allocate_index(size_t n);
+    void             deallocate_index(elem_ptr_pointer p, size_t n) noexcept;
+    void             release_index() noexcept;
+    void             release_index(std::false_type /*unused*/) noexcept;
+    void             release_index(std::true_type /*unused*/) noexcept;
+    void             reallocate_index(size_t n);
     void     set_ptrs(poly_copy_descr p);
     void     swap_ptrs(vector&& rhs);
-    template <class T, typename... Args> void push_back_new_elem(type_tag<T> t, Args&&... args);
     template <class T, typename... Args>
-    void         push_back_new_elem_w_storage_increase(type_tag<T> t, Args&&... args);
-    void         push_back_new_elem_w_storage_increase_copy(vector& v, std::true_type /*unused*/);
-    void         push_back_new_elem_w_storage_increase_copy(vector& v, std::false_type /*unused*/);
+    void insert_new_elem(size_t pos, type_tag<T> t, Args&&... args);
+    template <class T, typename... Args>
+    bool insert_new_elem_into_hole(size_t pos, type_tag<T> t, Args&&... args);
+    template <class T, typename... Args>
+    void construct_new_elem(void_pointer storage, size_t pos, type_tag<T> t, Args&&... args);
+    template <class T, typename... Args>
+    void insert_new_elem_w_storage_increase(size_t pos, type_tag<T> t, Args&&... args);
+    template <class T, typename... Args>
+    void insert_new_elem_w_storage_increase(
+        std::false_type /*unused*/, size_t pos, type_tag<T> t, Args&&... args);
+    template <class T, typename... Args>
+    void insert_new_elem_w_storage_increase(
+        std::true_type /*unused*/, size_t pos, type_tag<T> t, Args&&... args);
+    template <class T, typename... Args>
+    void insert_new_elem_w_storage_increase_impl(
+        vector& v, std::true_type /*unused*/, size_t pos, type_tag<T> t, Args&&... args);
+    template <class T, typename... Args>
+    void insert_new_elem_w_storage_increase_impl(
+        vector& v, std::false_type /*unused*/, size_t pos, type_tag<T> t, Args&&... args);
     bool         can_construct_new_elem(size_t s, size_t align) noexcept;
     void_pointer next_aligned_storage(size_t align) const noexcept;
     size_t       avg_obj_size(size_t align = 1) const noexcept;
+    void_pointer           index_begin() const noexcept;
+    void_pointer           index_begin(std::false_type /*unused*/) const noexcept;
+    void_pointer           index_begin(std::true_type /*unused*/) const noexcept;
+    void_pointer           index_end() const noexcept;
+    void_pointer           index_end(std::false_type /*unused*/) const noexcept;
+    void_pointer           index_end(std::true_type /*unused*/) const noexcept;
     elem_ptr_pointer       begin_elem() noexcept;
     elem_ptr_const_pointer cbegin_elem() const noexcept;
     elem_ptr_pointer       end_elem() noexcept;
@@ -858,68 +2079,126 @@ private:
     elem_ptr_const_pointer end_elem() const noexcept;
     elem_ptr_const_pointer last_elem() const noexcept;
     void_pointer           free_storage() const noexcept;
+    void_pointer           last_storage_end() const noexcept;
+    void_pointer           storage_end(elem_ptr_const_pointer p) const noexcept;
     ////////////////////////////
     // Members
     ////////////////////////////
-    elem_ptr_pointer _free_elem;
-    void_pointer     _begin_storage;
-    size_t           _align_max;
+    elem_ptr_pointer                _free_elem;
+    void_pointer                    _begin_storage;
+    void_pointer                    _free_storage;
+    size_t                          _align_max;
+    storage_accounting              _stats;
+    /// empty without full tracking, so they share a word with the flag
+    free_holes                      _holes;
+    defrag_cursor                   _defrag_cursor;
+    bool                            _address_ordered;
 };
 
-template <class IF, class Allocator, class CloningPolicy>
-void swap(
-    vector<IF, Allocator, CloningPolicy>& lhs, vector<IF, Allocator, CloningPolicy>& rhs) noexcept
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+void swap(vector<IF, Allocator, CloningPolicy, Layout>& lhs,
+    vector<IF, Allocator, CloningPolicy, Layout>& rhs) noexcept
 {
     lhs.swap(rhs);
 }
+
+template <class IF, class Allocator, class CloningPolicy, class Layout, class Pred>
+auto erase_if(vector<IF, Allocator, CloningPolicy, Layout>& v, Pred pred) ->
+    typename vector<IF, Allocator, CloningPolicy, Layout>::size_type
+{
+    return v.remove_if(std::move(pred));
+}
 // TODO(fecja): relational operators
 
 /////////////////////////
 // implementation
 ////////////////////////
-template <class I, class A, class C>
-inline vector<I, A, C>::vector()
+template <class I, class A, class C, class L>
+inline vector<I, A, C, L>::vector()
     : _free_elem {}
     , _begin_storage {}
+    , _free_storage {}
     , _align_max { default_alignement }
+    , _stats {}
+    , _holes {}
+    , _defrag_cursor {}
+    , _address_ordered { true }
 {
 }
 
-template <class I, class A, class C>
-inline vector<I, A, C>::vector(const allocator_type& alloc)
+template <class I, class A, class C, class L>
+inline vector<I, A, C, L>::vector(const allocator_type& alloc)
     : vector_impl::allocator_base<allocator_type>(alloc)
     , _free_elem {}
     , _begin_storage {}
+    , _free_storage {}
     , _align_max { default_alignement }
+    , _stats {}
+    , _holes {}
+    , _defrag_cursor {}
+    , _address_ordered { true }
 {
 }
 
-template <class I, class A, class C>
-inline vector<I, A, C>::vector(const vector& other)
-    : vector_impl::allocator_base<allocator_type>(other.base())
-    , _free_elem { begin_elem() }
-    , _begin_storage { begin_elem() + other.capacity() }
+template <class I, class A, class C, class L>
+inline vector<I, A, C, L>::vector(const vector& other)
+    : vector_impl::allocator_base<allocator_type>(other.base(), other.copy_storage_size())
+    , _free_elem {}
+    , _begin_storage {}
+    , _free_storage {}
     , _align_max { other._align_max }
+    , _stats { other._stats }
+    , _holes {}
+    , _defrag_cursor {}
+    , _address_ordered { true }
 {
-    set_ptrs(poly_uninitialized_copy(base(), begin_elem(), other.begin_elem(), other.end_elem(),
-        other.last_elem(), other.max_align()));
+    init_ptrs(other.capacity());
+    try {
+        set_ptrs(other.poly_uninitialized_copy(base(), begin_elem(), _begin_storage,
+            other.end_elem(), other.capacity(), other.max_align()));
+    } catch (...) {
+        release_index();
+        throw;
+    }
 }
 
-template <class I, class A, class C>
-inline vector<I, A, C>::vector(vector&& other) noexcept
+template <class I, class A, class C, class L>
+inline vector<I, A, C, L>::vector(vector&& other) noexcept
     : vector_impl::allocator_base<allocator_type>(std::move(other.base()))
     , _free_elem { other._free_elem }
     , _begin_storage { other._begin_storage }
+    , _free_storage { other._free_storage }
     , _align_max { other._align_max }
+    , _stats { other._stats }
+    , _holes { other._holes }
+    , _defrag_cursor { other._defrag_cursor }
+    , _address_ordered { other._address_ordered }
 {
+    this->swap_index(other);
     other._begin_storage = other._free_elem = nullptr;
+    other._free_storage                     = nullptr;
+    other._address_ordered                  = true;
     other._align_max                        = default_alignement;
+    other._stats                            = storage_accounting {};
+    other._holes.clear();
+    other._defrag_cursor.reset();
 }
 
-template <class I, class A, class C> inline vector<I, A, C>::~vector() { tidy(); }
+template <class I, class A, class C, class L>
+template <typename... T, typename>
+inline vector<I, A, C, L>::vector(T&&... objs)
+    : vector()
+{
+    using expand = int[];
+    init_layout_for<std::decay_t<T>...>();
+    (void)expand { 0,
+        (insert_new_elem(size(), type_tag<std::decay_t<T>> {}, std::forward<T>(objs)), 0)... };
+}
 
-template <class I, class A, class C>
-inline vector<I, A, C>& vector<I, A, C>::operator=(const vector& rhs)
+template <class I, class A, class C, class L> inline vector<I, A, C, L>::~vector() { tidy(); }
+
+template <class I, class A, class C, class L>
+inline vector<I, A, C, L>& vector<I, A, C, L>::operator=(const vector& rhs)
 {
     if (this != &rhs) {
         copy_assign_impl(rhs);
@@ -927,8 +2206,8 @@ inline vector<I, A, C>& vector<I, A, C>::operator=(const vector& rhs)
     return *this;
 }
 
-template <class I, class A, class C>
-inline vector<I, A, C>& vector<I, A, C>::operator=(vector&& rhs) noexcept
+template <class I, class A, class C, class L>
+inline vector<I, A, C, L>& vector<I, A, C, L>::operator=(vector&& rhs) noexcept
 {
     if (this != &rhs) {
         move_assign_impl(std::move(rhs));
@@ -936,175 +2215,531 @@ inline vector<I, A, C>& vector<I, A, C>::operator=(vector&& rhs) noexcept
     return *this;
 }
 
-template <class I, class A, class C>
+template <class I, class A, class C, class L>
 template <typename T>
-inline auto vector<I, A, C>::push_back(T&& obj)
+inline auto vector<I, A, C, L>::push_back(T&& obj)
     -> std::enable_if_t<std::is_base_of<interface_type, std::decay_t<T>>::value>
 {
     using TT         = std::decay_t<T>;
     constexpr auto s = sizeof(TT);
     constexpr auto a = alignof(TT);
     if (!can_construct_new_elem(s, a)) {
-        push_back_new_elem_w_storage_increase(type_tag<TT> {}, std::forward<T>(obj));
+        insert_new_elem_w_storage_increase(size(), type_tag<TT> {}, std::forward<T>(obj));
     } else {
-        push_back_new_elem(type_tag<TT> {}, std::forward<T>(obj));
+        insert_new_elem(size(), type_tag<TT> {}, std::forward<T>(obj));
     }
 }
 
-template <class IF, class Allocator, class CloningPolicy>
+template <class IF, class Allocator, class CloningPolicy, class Layout>
 template <typename T, typename... Args>
-inline auto vector<IF, Allocator, CloningPolicy>::emplace_back(Args&&... args)
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::emplace_back(Args&&... args)
     -> std::enable_if_t<std::is_base_of<interface_type, T>::value, interface_reference>
 {
     constexpr auto s = sizeof(T);
     constexpr auto a = alignof(T);
     if (!can_construct_new_elem(s, a)) {
-        push_back_new_elem_w_storage_increase(type_tag<T> {}, std::forward<Args>(args)...);
+        insert_new_elem_w_storage_increase(size(), type_tag<T> {}, std::forward<Args>(args)...);
     } else {
-        push_back_new_elem(type_tag<T> {}, std::forward<Args>(args)...);
+        insert_new_elem(size(), type_tag<T> {}, std::forward<Args>(args)...);
     }
     return back();
 }
 
-template <class I, class A, class C> inline void vector<I, A, C>::pop_back() noexcept
+template <class I, class A, class C, class L> inline void vector<I, A, C, L>::pop_back() noexcept
 {
     clear_till_end(_free_elem - 1);
 }
 
-template <class I, class A, class C> inline void vector<I, A, C>::clear() noexcept
+template <class I, class A, class C, class L> inline void vector<I, A, C, L>::clear() noexcept
 {
     clear_till_end(begin_elem());
     _align_max = default_alignement;
 }
 
-template <class I, class A, class C> inline void vector<I, A, C>::swap(vector& x) noexcept
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::swap(vector& x) noexcept
 {
     using std::swap;
     base().swap(x.base());
+    this->swap_index(x);
     swap(_free_elem, x._free_elem);
     swap(_begin_storage, x._begin_storage);
+    swap(_free_storage, x._free_storage);
+    swap(_address_ordered, x._address_ordered);
     swap(_align_max, x._align_max);
+    swap(_stats, x._stats);
+    swap(_holes, x._holes);
+    swap(_defrag_cursor, x._defrag_cursor);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::erase(const_iterator position) -> iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::erase(const_iterator position) -> iterator
 {
     return erase(position, position + 1);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::erase(const_iterator first, const_iterator last) -> iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::erase(const_iterator first, const_iterator last) -> iterator
 {
     auto eptr_first = begin_elem() + (first - begin());
-    auto ret        = last == end() ? clear_till_end(eptr_first)
-                                    : erase_internal_range(eptr_first, begin_elem() + (last - begin()));
+    auto ret        = last == end()
+               ? clear_till_end(eptr_first)
+               : erase_internal_range(eptr_first, begin_elem() + (last - begin()));
     if (empty()) {
         _align_max = default_alignement;
     }
     return ret;
 }
 
-template <class I, class A, class C> inline auto vector<I, A, C>::begin() noexcept -> iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::erase_unordered(const_iterator position) noexcept -> iterator
+{
+    using std::swap;
+    const auto elem = begin_elem() + (position - begin());
+    const auto last = std::prev(_free_elem);
+    if (elem == last) {
+        clear_till_end(last);
+        if (empty()) {
+            _align_max = default_alignement;
+        }
+        return end();
+    }
+    // in an address ordered layout the freed bytes reach up to the next object
+    const auto hole_end
+        = _address_ordered ? std::next(elem)->storage(_begin_storage) : storage_end(elem);
+    const auto hole_begin = elem->storage(_begin_storage);
+    const auto hole       = next_aligned_storage(hole_begin, placement_align(last->align()));
+    const auto storage    = last->storage(_begin_storage);
+    if (_address_ordered) {
+        _holes.forget(hole_begin, hole_end);
+    }
+    destroy_elem(elem);
+    swap(*elem, *last);
+    _free_elem = last;
+    const auto movable = trivially_relocatable(elem) || interface_type_noexcept_movable::value;
+    if (!movable || static_cast<pointer>(hole) + elem->size() > static_cast<pointer>(hole_end)) {
+        // the object stays at the top of the storage, out of the order of the entries
+        _address_ordered = _address_ordered && elem == std::prev(_free_elem);
+        if (hole_end == _free_storage) {
+            _free_storage = hole_begin;
+        } else {
+            _holes.add(hole_begin, hole_end);
+        }
+        return iterator(elem, _begin_storage);
+    }
+    relocate_object(elem, hole);
+    _holes.add(static_cast<pointer>(hole) + elem->size(), hole_end);
+    if (_address_ordered) {
+        _free_storage = last_storage_end();
+        _holes.forget_from(_free_storage);
+    } else if (static_cast<pointer>(storage) + elem->size() == _free_storage) {
+        _free_storage = storage;
+    } else {
+        _holes.add(storage, static_cast<pointer>(storage) + elem->size());
+    }
+    return iterator(elem, _begin_storage);
+}
+
+template <class I, class A, class C, class L>
+template <class Pred>
+inline auto vector<I, A, C, L>::remove_if(Pred pred) -> size_type
+{
+    using std::swap;
+    const auto   old_size = size();
+    auto         elem     = begin_elem();
+    auto         dst      = begin_elem();
+    void_pointer free_begin {};
+    void_pointer run_first {};
+    void_pointer run_last {};
+    void_pointer run_dst {};
+    try {
+        for (; elem != end_elem(); ++elem) {
+            if (pred(*elem->object(_begin_storage))) {
+                const auto storage = elem->storage(_begin_storage);
+                const auto end     = storage_end(elem);
+                destroy_elem(elem);
+                if (!_address_ordered) {
+                    _holes.add(storage, end);
+                } else if (!free_begin) {
+                    _holes.forget_from(storage);
+                }
+                free_begin = free_begin ? free_begin : storage;
+                continue;
+            }
+            // an unordered layout only drops the index entries, like erase
+            if (free_begin && _address_ordered) {
+                auto storage = elem->storage(_begin_storage);
+                auto ns      = next_aligned_storage(free_begin, placement_align(elem->align()));
+                if (trivially_relocatable(elem)) {
+                    if (run_last != storage
+                        || storage_size(run_dst, ns) != storage_size(run_first, run_last)) {
+                        relocate_bytes(run_dst, run_first, run_last);
+                        run_first = storage;
+                        run_dst   = ns;
+                    }
+                    run_last = static_cast<pointer>(storage) + elem->size();
+                    elem->place(_begin_storage, ns, rebased_object(*elem, _begin_storage, ns));
+                } else {
+                    relocate_bytes(run_dst, run_first, run_last);
+                    run_first = run_last = run_dst = nullptr;
+                    // an object overlapping its destination stays where it is
+                    if (storage_size(ns, storage) >= elem->size()) {
+                        auto obj = cloning_policy_traits::move(elem->policy(),
+                            base().get_allocator_ref(), elem->object(_begin_storage), ns);
+                        cloning_policy_traits::destroy(elem->policy(),
+                            base().get_allocator_ref(), elem->object(_begin_storage));
+                        elem->place(_begin_storage, ns, obj);
+                    } else {
+                        _holes.add(free_begin, storage);
+                        ns = storage;
+                    }
+                }
+                free_begin = static_cast<pointer>(ns) + elem->size();
+            }
+            swap(*dst++, *elem);
+        }
+        relocate_bytes(run_dst, run_first, run_last);
+    } catch (...) {
+        // the objects not processed yet stay where they are
+        relocate_bytes(run_dst, run_first, run_last);
+        for (; elem != end_elem(); ++elem) {
+            swap(*dst++, *elem);
+        }
+        _free_elem = dst;
+        if (_address_ordered) {
+            _free_storage = last_storage_end();
+            _holes.forget_from(_free_storage);
+        }
+        throw;
+    }
+    _free_elem       = dst;
+    _address_ordered = _address_ordered || empty();
+    if (_address_ordered) {
+        _free_storage = last_storage_end();
+        _holes.forget_from(_free_storage);
+    }
+    if (empty()) {
+        _align_max = default_alignement;
+        _holes.clear();
+    }
+    return old_size - size();
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::defragment(size_type max_bytes) -> size_type
+{
+    size_type moved = 0;
+    if (empty()) {
+        return moved;
+    }
+    auto cursor = _defrag_cursor.position();
+    if (cursor >= size()) {
+        cursor = 0;
+    }
+    auto elem = begin_elem() + cursor;
+    auto dst  = elem == begin_elem() ? _begin_storage : storage_end(std::prev(elem));
+    // objects are only moved to the free storage and above dst
+    _holes.forget_from(dst);
+    for (; elem != end_elem(); ++elem, ++cursor) {
+        const auto storage = elem->storage(_begin_storage);
+        const auto target  = next_aligned_storage(dst, placement_align(elem->align()));
+        const auto size    = elem->size();
+        // an object overlapping its destination can only be moved there by memmove, the others
+        // are moved twice, through the free storage above the objects
+        const auto staged = static_cast<pointer>(target) + size > static_cast<pointer>(storage)
+            && !trivially_relocatable(elem);
+        const auto cost        = staged ? 2 * size : size;
+        const auto has_staging = [&] {
+            const auto top = next_aligned_storage(placement_align(elem->align()));
+            return static_cast<pointer>(top) + size <= this->end_storage();
+        };
+        if (static_cast<pointer>(target) >= static_cast<pointer>(storage) || cost > max_bytes
+            || (staged && !has_staging())) {
+            // dst never goes below the point the holes were dropped from, in an unordered
+            // layout the storage of a skipped object can be lower
+            dst = std::max(dst, storage_end(elem));
+            continue;
+        }
+        if (moved + cost > max_bytes
+            || (!_address_ordered
+                && !evacuate_overlapping(elem, target, max_bytes - (cost - size), moved))
+            || (staged && !has_staging())) {
+            break;
+        }
+        if (staged) {
+            relocate_object(elem, next_aligned_storage(placement_align(elem->align())));
+            moved += size;
+        }
+        relocate_object(elem, target);
+        moved += size;
+        dst = static_cast<pointer>(target) + size;
+    }
+    _defrag_cursor.advance_to(cursor);
+    if (elem == end_elem()) {
+        // a completed pass may have restored the address order
+        _defrag_cursor.reset();
+        auto top       = _begin_storage;
+        auto ordered   = true;
+        for (auto p = begin_elem(); p != end_elem(); ++p) {
+            ordered = ordered && p->storage(_begin_storage) >= top;
+            top     = std::max(top, storage_end(p));
+        }
+        _address_ordered = ordered;
+        _free_storage    = top;
+    } else if (_address_ordered) {
+        _free_storage = last_storage_end();
+    }
+    _holes.forget_from(_free_storage);
+    return moved;
+}
+
+template <class I, class A, class C, class L>
+template <class Compare>
+inline void vector<I, A, C, L>::sort(Compare comp)
+{
+    // a throwing comparison leaves the entries in an unspecified order
+    const auto ordered = _address_ordered;
+    _address_ordered   = false;
+    std::sort(begin_elem(), end_elem(), index_compare(comp));
+    _address_ordered = ordered && storage_in_index_order();
+}
+
+template <class I, class A, class C, class L>
+template <class Compare>
+inline void vector<I, A, C, L>::stable_sort(Compare comp)
 {
-    return iterator(begin_elem());
+    const auto ordered = _address_ordered;
+    _address_ordered   = false;
+    std::stable_sort(begin_elem(), end_elem(), index_compare(comp));
+    _address_ordered = ordered && storage_in_index_order();
 }
 
-template <class I, class A, class C> inline auto vector<I, A, C>::end() noexcept -> iterator
+template <class I, class A, class C, class L> inline void vector<I, A, C, L>::relayout()
 {
-    return iterator(end_elem());
+    using copy = std::conditional_t<interface_type_noexcept_movable::value, std::false_type,
+        std::true_type>;
+    if (empty()) {
+        return;
+    }
+    if (_address_ordered && interface_type_noexcept_movable::value) {
+        // the objects already follow the index, closing the gaps between them is enough unless
+        // an object could not be moved for lack of free storage to move it through
+        _defrag_cursor.reset();
+        defragment(std::numeric_limits<size_type>::max());
+        auto packed = _address_ordered;
+        auto dst    = _begin_storage;
+        for (auto elem = begin_elem(); packed && elem != end_elem(); ++elem) {
+            packed = elem->storage(_begin_storage)
+                == next_aligned_storage(dst, placement_align(elem->align()));
+            dst = storage_end(elem);
+        }
+        if (packed) {
+            return;
+        }
+    }
+    // relative entries of an ordered vector would keep their offsets, holes included, in the
+    // new storage; the reallocation restores the flag
+    _address_ordered = false;
+    const auto new_size = std::max(static_cast<size_t>(base().size()),
+        index_bytes(capacity()) + _align_max - 1 + storage_extent(_align_max));
+    check_storage_size(new_size);
+    my_base s(new_size,
+        allocator_traits::select_on_container_copy_construction(base().get_allocator_ref()));
+    obtain_storage(std::move(s), capacity(), _align_max, copy {});
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::stable_partition_by_type()
+{
+    const auto ordered = _address_ordered;
+    _address_ordered   = false;
+    // one partition per type, the number of types is expected to be small
+    for (auto first = begin_elem(); first != end_elem();) {
+        const elem_ptr type_of_first = *first;
+        first = std::stable_partition(first, end_elem(), [&](const elem_ptr& e) {
+            return cloning_policy_traits::same_type(type_of_first.policy(),
+                *type_of_first.object(_begin_storage), e.policy(), *e.object(_begin_storage));
+        });
+    }
+    _address_ordered = ordered && storage_in_index_order();
+}
+
+template <class I, class A, class C, class L> inline void vector<I, A, C, L>::group_by_type()
+{
+    stable_partition_by_type();
+    relayout();
+}
+
+template <class I, class A, class C, class L>
+template <typename... Ts, class F>
+inline void vector<I, A, C, L>::visit(F&& f)
+{
+    for (auto elem = begin_elem(); elem != end_elem(); ++elem) {
+        visit_elem<interface_reference>(
+            *elem, *elem->object(_begin_storage), f, type_tag<Ts> {}...);
+    }
+}
+
+template <class I, class A, class C, class L>
+template <typename... Ts, class F>
+inline void vector<I, A, C, L>::visit(F&& f) const
+{
+    for (auto elem = begin_elem(); elem != end_elem(); ++elem) {
+        visit_elem<const_interface_reference>(
+            *elem, *elem->object(_begin_storage), f, type_tag<const Ts> {}...);
+    }
+}
+
+template <class I, class A, class C, class L>
+template <typename... Ts, class F>
+inline void vector<I, A, C, L>::for_each_as(F&& f)
+{
+    visit<Ts...>(std::forward<F>(f));
+}
+
+template <class I, class A, class C, class L>
+template <typename... Ts, class F>
+inline void vector<I, A, C, L>::for_each_as(F&& f) const
+{
+    visit<Ts...>(std::forward<F>(f));
+}
+
+template <class I, class A, class C, class L>
+template <class Ref, class F>
+inline void vector<I, A, C, L>::visit_elem(const elem_ptr& /*unused*/, Ref obj, F& f)
+{
+    f(obj);
+}
+
+template <class I, class A, class C, class L>
+template <class Ref, class F, typename T, typename... Ts>
+inline void vector<I, A, C, L>::visit_elem(
+    const elem_ptr& e, Ref obj, F& f, type_tag<T> /*unused*/, type_tag<Ts>... ts)
+{
+    using type = std::remove_const_t<T>;
+    static_assert(std::is_base_of<interface_type, type>::value,
+        "visited types must implement the interface");
+    if (cloning_policy_traits::template holds<type>(e.policy(), obj)) {
+        f(static_cast<T&>(obj));
+        return;
+    }
+    visit_elem<Ref>(e, obj, f, ts...);
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::begin() noexcept -> iterator
+{
+    return iterator(begin_elem(), _begin_storage);
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::end() noexcept -> iterator
+{
+    return iterator(end_elem(), _begin_storage);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::begin() const noexcept -> const_iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::begin() const noexcept -> const_iterator
 {
-    return const_iterator(begin_elem());
+    return const_iterator(begin_elem(), _begin_storage);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::end() const noexcept -> const_iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::end() const noexcept -> const_iterator
 {
-    return const_iterator(end_elem());
+    return const_iterator(end_elem(), _begin_storage);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::rbegin() noexcept -> reverse_iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::rbegin() noexcept -> reverse_iterator
 {
     return std::make_reverse_iterator(end());
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::rend() noexcept -> reverse_iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::rend() noexcept -> reverse_iterator
 {
     return std::make_reverse_iterator(begin());
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::rbegin() const noexcept -> const_reverse_iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::rbegin() const noexcept -> const_reverse_iterator
 {
     return std::make_reverse_iterator(end());
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::rend() const noexcept -> const_reverse_iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::rend() const noexcept -> const_reverse_iterator
 {
     return std::make_reverse_iterator(begin());
 }
 
-template <class IF, class Allocator, class CloningPolicy>
-inline auto vector<IF, Allocator, CloningPolicy>::cbegin() const noexcept -> const_iterator
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::cbegin() const noexcept -> const_iterator
 {
     return begin();
 }
 
-template <class IF, class Allocator, class CloningPolicy>
-inline auto vector<IF, Allocator, CloningPolicy>::cend() const noexcept -> const_iterator
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::cend() const noexcept -> const_iterator
 {
     return end();
 }
 
-template <class I, class A, class C> inline size_t vector<I, A, C>::size() const noexcept
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::size() const noexcept
 {
     return static_cast<size_t>(_free_elem - begin_elem());
 }
 
-template <class I, class A, class C>
-inline std::pair<size_t, size_t> vector<I, A, C>::sizes() const noexcept
+template <class I, class A, class C, class L>
+inline std::pair<size_t, size_t> vector<I, A, C, L>::sizes() const noexcept
 {
     return std::make_pair(size(), avg_obj_size());
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::capacity() const noexcept -> size_type
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::capacity() const noexcept -> size_type
 {
-    return storage_size(begin_elem(), _begin_storage) / sizeof(elem_ptr);
+    return storage_size(index_begin(), index_end()) / sizeof(elem_ptr);
 }
 
-template <class I, class A, class C>
-inline std::pair<size_t, size_t> vector<I, A, C>::capacities() const noexcept
+template <class I, class A, class C, class L>
+inline std::pair<size_t, size_t> vector<I, A, C, L>::capacities() const noexcept
 {
     return std::make_pair(capacity(), storage_size(_begin_storage, this->_end_storage));
 }
 
-template <class I, class A, class C> inline bool vector<I, A, C>::empty() const noexcept
+template <class I, class A, class C, class L> inline bool vector<I, A, C, L>::empty() const noexcept
 {
     return begin_elem() == _free_elem;
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::max_size() const noexcept -> size_type
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::max_size() const noexcept -> size_type
 {
     auto avg = avg_obj_size() ? avg_obj_size() : 4 * sizeof(void_pointer);
-    return allocator_traits::max_size(this->get_allocator_ref()) / (sizeof(elem_ptr) + avg);
+    return std::min<size_t>(allocator_traits::max_size(this->get_allocator_ref()),
+               elem_ptr::max_storage_size)
+        / (sizeof(elem_ptr) + avg);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::max_align() const noexcept -> size_type
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::max_align() const noexcept -> size_type
 {
     return _align_max;
 }
 
-template <class I, class A, class C>
-inline void vector<I, A, C>::reserve(size_type n, size_type avg_size, size_type max_align)
+template <class I, class A, class C, class L>
+inline fragmentation_info vector<I, A, C, L>::fragmentation() const noexcept
+{
+    const auto holes = _holes.totals();
+    return fragmentation_info { holes.first, holes.second,
+        storage_size(_begin_storage, free_storage()) - _stats.payload };
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::reserve(size_type n, size_type avg_size, size_type max_align)
 {
     using copy = std::conditional_t<interface_type_noexcept_movable::value, std::false_type,
         std::true_type>;
@@ -1117,31 +2752,106 @@ inline void vector<I, A, C>::reserve(size_type n, size_type avg_size, size_type
     increase_storage(n, avg_size, max_align, copy {});
 }
 
-template <class I, class A, class C> inline void vector<I, A, C>::reserve(size_type n)
+template <class I, class A, class C, class L> inline void vector<I, A, C, L>::reserve(size_type n)
 {
     reserve(n, default_avg_size);
 }
 
-template <class I, class A, class C>
-inline void vector<I, A, C>::reserve(std::pair<size_t, size_t> s)
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::reserve(std::pair<size_t, size_t> s)
 {
     reserve(s.first, s.second);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::operator[](size_t n) noexcept -> interface_reference
+template <class I, class A, class C, class L>
+template <typename... T, typename... Counts>
+inline void vector<I, A, C, L>::reserve_for(Counts... counts)
+{
+    static_assert(sizeof...(T) == sizeof...(Counts), "one count is needed per type");
+    const auto mix = std::array<object_count, sizeof...(T)> { { count_of<T>(
+        static_cast<size_t>(counts))... } };
+    reserve_for(mix.begin(), mix.end());
+}
+
+template <class I, class A, class C, class L>
+template <class InputIt>
+inline void vector<I, A, C, L>::reserve_for(InputIt first, InputIt last)
+{
+    using copy = std::conditional_t<interface_type_noexcept_movable::value, std::false_type,
+        std::true_type>;
+    auto n     = size();
+    auto align = _align_max;
+    for (auto it = first; it != last; ++it) {
+        n += it->count;
+        align = std::max(align, it->align);
+    }
+    // the objects can be added in any order, so each of them takes its worst case storage
+    const auto objects
+        = std::accumulate(first, last, size_t(0), [align](size_t val, const auto& c) {
+              return val + c.count * packing_policy::appended_size(c.size, c.align, align);
+          });
+    const auto free
+        = next_aligned_storage(free_storage(), packing_policy::placement_align(1, align));
+    const auto kept = storage_size(_begin_storage, free) + objects;
+    if (n <= capacity() && align <= _align_max && this->storage()
+        && kept <= storage_size(_begin_storage, this->end_storage())) {
+        return;
+    }
+    if (n > max_size()) {
+        throw std::length_error("poly::vector reserve size too big");
+    }
+    auto extent = align - 1 + storage_extent_estimate(align) + objects;
+    if (elem_ptr::is_relative::value && _address_ordered && align == _align_max && !empty()) {
+        // the current objects might keep their offsets
+        extent = std::max(extent, kept);
+    }
+    const auto new_size = index_bytes(n) + extent;
+    check_storage_size(new_size);
+    my_base s(new_size,
+        allocator_traits::select_on_container_copy_construction(base().get_allocator_ref()));
+    obtain_storage(std::move(s), n, align, copy {});
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::reserve_for(std::initializer_list<object_count> counts)
 {
-    return *begin_elem()[n].ptr.second;
+    reserve_for(counts.begin(), counts.end());
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::operator[](size_t n) const noexcept -> const_interface_reference
+template <class I, class A, class C, class L> inline void vector<I, A, C, L>::shrink_to_fit()
 {
-    return *begin_elem()[n].ptr.second;
+    using copy = std::conditional_t<interface_type_noexcept_movable::value, std::false_type,
+        std::true_type>;
+    if (empty()) {
+        tidy();
+        return;
+    }
+    const auto align    = std::accumulate(begin_elem(), end_elem(), default_alignement,
+        [](size_t val, const elem_ptr& p) { return std::max(val, p.align()); });
+    const auto new_size = index_bytes(size()) + align - 1 + storage_extent(align);
+    if (capacity() == size() && static_cast<size_t>(base().size()) <= new_size) {
+        return;
+    }
+    check_storage_size(new_size);
+    my_base s(new_size,
+        allocator_traits::select_on_container_copy_construction(base().get_allocator_ref()));
+    obtain_storage(std::move(s), size(), align, copy {});
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::at(size_t n) -> interface_reference
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::operator[](size_t n) noexcept -> interface_reference
+{
+    return *begin_elem()[n].object(_begin_storage);
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::operator[](size_t n) const noexcept -> const_interface_reference
+{
+    return *begin_elem()[n].object(_begin_storage);
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::at(size_t n) -> interface_reference
 {
     if (n >= size()) {
         throw std::out_of_range { "poly::vector out of range access" };
@@ -1149,8 +2859,8 @@ inline auto vector<I, A, C>::at(size_t n) -> interface_reference
     return (*this)[n];
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::at(size_t n) const -> const_interface_reference
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::at(size_t n) const -> const_interface_reference
 {
     if (n >= size()) {
         throw std::out_of_range { "poly::vector out of range access" };
@@ -1158,50 +2868,50 @@ inline auto vector<I, A, C>::at(size_t n) const -> const_interface_reference
     return (*this)[n];
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::front() noexcept -> interface_reference
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::front() noexcept -> interface_reference
 {
     return (*this)[0];
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::front() const noexcept -> const_interface_reference
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::front() const noexcept -> const_interface_reference
 {
     return (*this)[0];
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::back() noexcept -> interface_reference
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::back() noexcept -> interface_reference
 {
     return (*this)[size() - 1];
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::back() const noexcept -> const_interface_reference
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::back() const noexcept -> const_interface_reference
 {
     return (*this)[size() - 1];
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::data() noexcept -> std::pair<void_pointer, void_pointer>
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::data() noexcept -> std::pair<void_pointer, void_pointer>
 {
     return std::make_pair(base()._storage, base()._end_storage);
 }
-template <class I, class A, class C>
-inline auto vector<I, A, C>::data() const noexcept
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::data() const noexcept
     -> std::pair<const_void_pointer, const_void_pointer>
 {
     return std::make_pair(base()._storage, base()._end_storage);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::get_allocator() const noexcept -> allocator_type
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::get_allocator() const noexcept -> allocator_type
 {
     return my_base::get_allocator_ref();
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::next_aligned_storage(void_pointer p, size_t align) noexcept
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::next_aligned_storage(void_pointer p, size_t align) noexcept
     -> void_pointer
 {
     auto v = static_cast<pointer>(p) - static_cast<pointer>(nullptr);
@@ -1209,256 +2919,754 @@ inline auto vector<I, A, C>::next_aligned_storage(void_pointer p, size_t align)
     return static_cast<pointer>(p) + a;
 }
 
-template <class I, class A, class C>
-inline size_t vector<I, A, C>::storage_size(const_void_pointer b, const_void_pointer e) noexcept
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::misalignment(void_pointer p, size_t align) noexcept
+{
+    return static_cast<size_t>(static_cast<pointer>(p) - static_cast<pointer>(nullptr)) % align;
+}
+
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::storage_size(const_void_pointer b, const_void_pointer e) noexcept
 {
     using const_pointer_t = typename allocator_traits::const_pointer;
     return static_cast<size_t>(static_cast<const_pointer_t>(e) - static_cast<const_pointer_t>(b));
 }
 
-template <class I, class A, class C>
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::check_storage_size(size_t n)
+{
+    if (n > elem_ptr::max_storage_size) {
+        throw std::length_error("poly::vector storage size too big for the index");
+    }
+}
+
+template <class I, class A, class C, class L>
 template <typename CopyOrMove>
-inline void vector<I, A, C>::increase_storage(
+inline void vector<I, A, C, L>::increase_storage(
     size_t desired_size, size_t curr_elem_size, size_t align, CopyOrMove /*unused*/)
 {
-    auto    sizes = calculate_storage_size(desired_size, curr_elem_size, align);
+    auto sizes = calculate_storage_size(desired_size, curr_elem_size, align);
+    check_storage_size(sizes.first);
     my_base s(sizes.first,
         allocator_traits::select_on_container_copy_construction(base().get_allocator_ref()));
     obtain_storage(std::move(s), desired_size, sizes.second, CopyOrMove {});
 }
 
-template <class I, class A, class C>
-inline void vector<I, A, C>::obtain_storage(
-    my_base&& a, size_t n, size_t max_align, std::true_type /*unused*/)
+template <class I, class A, class C, class L>
+template <typename CopyOrMove>
+inline void vector<I, A, C, L>::obtain_storage(
+    my_base&& a, size_t n, size_t max_align, CopyOrMove /*unused*/)
+{
+    obtain_storage(std::move(a), n, max_align, CopyOrMove {}, separate_index {});
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::obtain_storage(my_base&& a, size_t n, size_t max_align,
+    std::true_type /*unused*/, std::false_type /*unused*/)
+{
+    const auto dst   = static_cast<elem_ptr_pointer>(a.storage());
+    auto       ret   = poly_uninitialized_copy(a, dst, dst + n, end_elem(), n, max_align);
+    const auto stats = _stats;
+    tidy();
+    base().swap(a);
+    set_ptrs(ret);
+    _align_max = max_align;
+    _stats     = stats;
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::obtain_storage(my_base&& a, size_t n, size_t max_align,
+    std::false_type /*unused*/, std::false_type /*unused*/) noexcept
 {
-    auto ret = poly_uninitialized_copy(
-        a, a.storage(), begin_elem(), begin_elem(), std::next(begin_elem(), n), max_align);
+    const auto stats = _stats;
+    const auto dst   = static_cast<elem_ptr_pointer>(a.storage());
+    auto       ret   = poly_uninitialized_relocate(a, dst, dst + n, end_elem(), n, max_align);
     tidy();
     base().swap(a);
     set_ptrs(ret);
     _align_max = max_align;
+    _stats     = stats;
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::obtain_storage(my_base&& a, size_t n, size_t max_align,
+    std::true_type /*unused*/, std::true_type /*unused*/)
+{
+    const auto      index = allocate_index(n);
+    poly_copy_descr ret;
+    try {
+        ret = poly_uninitialized_copy(a, index, a.storage(), end_elem(), n, max_align);
+    } catch (...) {
+        deallocate_index(index, n);
+        throw;
+    }
+    const auto stats = _stats;
+    tidy();
+    base().swap(a);
+    this->_index     = index;
+    this->_end_index = index + n;
+    set_ptrs(ret);
+    _align_max = max_align;
+    _stats     = stats;
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::obtain_storage(my_base&& a, size_t n, size_t max_align,
+    std::false_type /*unused*/, std::true_type /*unused*/)
+{
+    // the objects are relocated under the same index entries
+    if (n != capacity()) {
+        reallocate_index(n);
+    }
+    const auto stats = _stats;
+    auto ret = poly_uninitialized_relocate(a, begin_elem(), a.storage(), end_elem(), n, max_align);
+    base().swap(a);
+    a.tidy();
+    set_ptrs(ret);
+    _align_max = max_align;
+    _stats     = stats;
+}
+
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline void vector<IF, Allocator, CloningPolicy, Layout>::init_layout(
+    size_t storage_size, size_t capacity, size_t align_max)
+{
+    check_storage_size(storage_size);
+    base().allocate(storage_size);
+    init_ptrs(capacity);
+    _align_max = align_max;
+}
+
+template <class I, class A, class C, class L>
+template <typename... T>
+inline void vector<I, A, C, L>::init_layout_for()
+{
+    using layout = vector_impl::static_layout<packing_policy, default_alignement, T...>;
+    constexpr auto extent       = layout::align - 1 + layout::extent();
+    const auto     storage_size = index_bytes(sizeof...(T)) + extent;
+    check_storage_size(storage_size);
+    init_layout(storage_size, sizeof...(T), layout::align);
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::base() noexcept -> my_base&
+{
+    return *this;
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::base() const noexcept -> const my_base&
+{
+    return *this;
+}
+
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::poly_uninitialized_copy(my_base& a,
+    elem_ptr_pointer dst_begin, void_pointer storage_begin, elem_ptr_const_pointer _free,
+    size_t capacity, size_t max_align) const -> poly_copy_descr
+{
+    const auto   keep_offsets = can_keep_offsets(storage_begin, a.end_storage(), _free, max_align);
+    const auto   dst_end      = dst_begin + capacity;
+    auto         dst          = dst_begin;
+    void_pointer dst_storage  = storage_begin;
+    // trivially copyable objects keeping their distance from the first one of their run are
+    // copied in one go, along with the padding between them
+    void_pointer run_first {};
+    void_pointer run_last {};
+    void_pointer run_dst {};
+    for (auto elem_dst = dst_begin; elem_dst != dst_end; ++elem_dst) {
+        a.construct(elem_dst);
+    }
+    if (keep_offsets) {
+        std::copy(begin_elem(), _free, dst_begin);
+    }
+    try {
+        for (auto elem = begin_elem(); elem != _free; ++elem, ++dst) {
+            const auto storage = elem->storage(_begin_storage);
+            const auto ns      = keep_offsets
+                     ? dst->storage(storage_begin)
+                     : next_aligned_storage(
+                         dst_storage, packing_policy::placement_align(elem->align(), max_align));
+            if (!keep_offsets) {
+                *dst = *elem;
+            }
+            if (trivially_copyable(elem)) {
+                if (!run_last || (run_last != storage && !_address_ordered)
+                    || storage_size(run_dst, ns) != storage_size(run_first, storage)) {
+                    copy_bytes(run_dst, run_first, run_last);
+                    run_first = storage;
+                    run_dst   = ns;
+                }
+                run_last = static_cast<pointer>(storage) + elem->size();
+                if (!keep_offsets) {
+                    dst->place(storage_begin, ns, rebased_object(*elem, _begin_storage, ns));
+                }
+            } else {
+                copy_bytes(run_dst, run_first, run_last);
+                run_first = run_last = run_dst = nullptr;
+                auto obj = elem->policy().clone(
+                    a.get_allocator_ref(), elem->object(_begin_storage), ns);
+                if (!keep_offsets) {
+                    dst->place(storage_begin, ns, obj);
+                }
+            }
+            dst_storage = static_cast<pointer>(ns) + dst->size();
+        }
+        copy_bytes(run_dst, run_first, run_last);
+        return std::make_tuple(dst, storage_begin, dst_storage);
+    } catch (...) {
+        while (dst-- != dst_begin) {
+            cloning_policy_traits::destroy(
+                dst->policy(), a.get_allocator_ref(), dst->object(storage_begin));
+        }
+        for (auto elem_dst = dst_begin; elem_dst != dst_end; ++elem_dst) {
+            a.destroy(elem_dst);
+        }
+        throw;
+    }
+}
+
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::poly_uninitialized_relocate(my_base& a,
+    elem_ptr_pointer dst_begin, void_pointer storage_begin, elem_ptr_const_pointer _free,
+    size_t capacity, size_t max_align) noexcept -> poly_copy_descr
+{
+    assert(_free == end_elem());
+    // a separate index stays in place, only the object storage of its entries is updated
+    const auto   in_place     = dst_begin == begin_elem();
+    const auto   keep_offsets = can_keep_offsets(storage_begin, a.end_storage(), _free, max_align);
+    auto         dst          = dst_begin;
+    void_pointer dst_storage  = storage_begin;
+    // consecutive trivially relocatable objects that keep their distance are copied in one go
+    void_pointer run_first {};
+    void_pointer run_last {};
+    void_pointer run_dst {};
+    for (auto elem_dst = dst_begin; !in_place && elem_dst != dst_begin + capacity; ++elem_dst) {
+        a.construct(elem_dst);
+    }
+    if (keep_offsets && !in_place) {
+        std::copy(cbegin_elem(), _free, dst_begin);
+    }
+    for (auto elem = begin_elem(); elem != end_elem(); ++elem, ++dst) {
+        const auto storage = elem->storage(_begin_storage);
+        const auto ns      = keep_offsets
+                 ? dst->storage(storage_begin)
+                 : next_aligned_storage(
+                     dst_storage, packing_policy::placement_align(elem->align(), max_align));
+        if (!keep_offsets && !in_place) {
+            *dst = *elem;
+        }
+        if (trivially_relocatable(elem)) {
+            if (run_last != storage
+                || storage_size(run_dst, ns) != storage_size(run_first, run_last)) {
+                relocate_bytes(run_dst, run_first, run_last);
+                run_first = storage;
+                run_dst   = ns;
+            }
+            run_last = static_cast<pointer>(storage) + elem->size();
+            if (!keep_offsets) {
+                dst->place(storage_begin, ns, rebased_object(*elem, _begin_storage, ns));
+            }
+        } else {
+            relocate_bytes(run_dst, run_first, run_last);
+            run_first = run_last = run_dst = nullptr;
+            auto obj = cloning_policy_traits::move(
+                elem->policy(), a.get_allocator_ref(), elem->object(_begin_storage), ns);
+            cloning_policy_traits::destroy(
+                elem->policy(), base().get_allocator_ref(), elem->object(_begin_storage));
+            if (!keep_offsets) {
+                dst->place(storage_begin, ns, obj);
+            }
+        }
+        if (!in_place) {
+            *elem = elem_ptr();
+        }
+        dst_storage = static_cast<pointer>(ns) + dst->size();
+    }
+    relocate_bytes(run_dst, run_first, run_last);
+    _free_elem       = begin_elem();
+    _free_storage    = _begin_storage;
+    _address_ordered = true;
+    _stats           = storage_accounting {};
+    _holes.clear();
+    return std::make_tuple(dst, storage_begin, dst_storage);
+}
+
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline bool vector<IF, Allocator, CloningPolicy, Layout>::trivially_relocatable(
+    elem_ptr_const_pointer p) const noexcept
+{
+    return cloning_policy_traits::trivially_relocatable(p->policy());
+}
+
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline bool vector<IF, Allocator, CloningPolicy, Layout>::trivially_copyable(
+    elem_ptr_const_pointer p) const noexcept
+{
+    return cloning_policy_traits::trivially_copyable(p->policy());
+}
+
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::rebased_object(
+    const elem_ptr& e, void_pointer base, void_pointer new_storage) noexcept -> interface_pointer
+{
+    const auto adjustment = storage_size(e.storage(base), e.object(base));
+    return static_cast<interface_pointer>(
+        static_cast<void_pointer>(static_cast<pointer>(new_storage) + adjustment));
+}
+
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline void vector<IF, Allocator, CloningPolicy, Layout>::relocate_bytes(
+    void_pointer dst, void_pointer first, void_pointer last) noexcept
+{
+    if (first != last) {
+        std::memmove(std::addressof(*static_cast<pointer>(dst)),
+            std::addressof(*static_cast<pointer>(first)), storage_size(first, last));
+    }
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::relocate_object(elem_ptr_pointer p, void_pointer dst)
+{
+    if (trivially_relocatable(p)) {
+        const auto storage = p->storage(_begin_storage);
+        relocate_bytes(dst, storage, static_cast<pointer>(storage) + p->size());
+        p->place(_begin_storage, dst, rebased_object(*p, _begin_storage, dst));
+        return;
+    }
+    auto obj = cloning_policy_traits::move(
+        p->policy(), base().get_allocator_ref(), p->object(_begin_storage), dst);
+    cloning_policy_traits::destroy(
+        p->policy(), base().get_allocator_ref(), p->object(_begin_storage));
+    p->place(_begin_storage, dst, obj);
+}
+
+template <class I, class A, class C, class L>
+inline bool vector<I, A, C, L>::evacuate_overlapping(
+    elem_ptr_const_pointer p, void_pointer dst, size_type max_bytes, size_type& moved)
+{
+    // in an unordered layout other objects may take the destination, they are moved to the
+    // free storage first
+    const auto dst_end = static_cast<pointer>(dst) + p->size();
+    for (auto e = begin_elem(); e != end_elem(); ++e) {
+        const auto storage = static_cast<pointer>(e->storage(_begin_storage));
+        if (e == p || storage >= dst_end || storage + e->size() <= static_cast<pointer>(dst)) {
+            continue;
+        }
+        const auto top = next_aligned_storage(placement_align(e->align()));
+        if (moved + e->size() + p->size() > max_bytes
+            || static_cast<pointer>(top) + e->size() > this->end_storage()) {
+            return false;
+        }
+        relocate_object(e, top);
+        moved += e->size();
+        _free_storage = static_cast<pointer>(top) + e->size();
+    }
+    return true;
+}
+
+template <class I, class A, class C, class L>
+inline bool vector<I, A, C, L>::storage_in_index_order() const noexcept
+{
+    return std::is_sorted(
+        begin_elem(), end_elem(), [this](const elem_ptr& lhs, const elem_ptr& rhs) {
+            return static_cast<const_pointer>(lhs.storage(_begin_storage))
+                < static_cast<const_pointer>(rhs.storage(_begin_storage));
+        });
 }
 
-template <class I, class A, class C>
-inline void vector<I, A, C>::obtain_storage(
-    my_base&& a, size_t n, size_t max_align, std::false_type /*unused*/) noexcept
+template <class I, class A, class C, class L>
+template <class Compare>
+inline auto vector<I, A, C, L>::index_compare(Compare& comp) const noexcept
 {
-    _align_max = max_align;
-    auto ret   = poly_uninitialized_move(
-        a, a.storage(), begin_elem(), end_elem(), std::next(begin_elem(), n), max_align);
-    tidy();
-    base().swap(a);
-    set_ptrs(ret);
-    _align_max = max_align;
+    return [this, &comp](const elem_ptr& lhs, const elem_ptr& rhs) {
+        return comp(static_cast<const_interface_reference>(*lhs.object(_begin_storage)),
+            static_cast<const_interface_reference>(*rhs.object(_begin_storage)));
+    };
 }
 
-template <class IF, class Allocator, class CloningPolicy>
-inline void vector<IF, Allocator, CloningPolicy>::init_layout(
-    size_t storage_size, size_t capacity, size_t align_max)
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline void vector<IF, Allocator, CloningPolicy, Layout>::copy_bytes(
+    void_pointer dst, void_pointer first, void_pointer last) noexcept
 {
-    base().allocate(storage_size);
-    init_ptrs(capacity);
-    _align_max = align_max;
+    if (first != last) {
+        std::memcpy(std::addressof(*static_cast<pointer>(dst)),
+            std::addressof(*static_cast<pointer>(first)), storage_size(first, last));
+    }
 }
 
-template <class I, class A, class C> inline auto vector<I, A, C>::base() noexcept -> my_base&
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline bool vector<IF, Allocator, CloningPolicy, Layout>::can_keep_offsets(void_pointer dst_base,
+    const_void_pointer dst_end, elem_ptr_const_pointer _free, size_t max_align) const noexcept
 {
-    return *this;
+    // relative entries can be copied as they are if every object can be placed at the same
+    // offset in the destination storage without violating its alignment, a copy of an
+    // unordered layout is laid out again instead
+    if (!elem_ptr::is_relative::value || _free == begin_elem() || !_address_ordered
+        || max_align != _align_max
+        || misalignment(dst_base, max_align) != misalignment(_begin_storage, max_align)) {
+        return false;
+    }
+    return storage_size(_begin_storage, free_storage()) <= storage_size(dst_base, dst_end);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::base() const noexcept -> const my_base&
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::copy_assign_impl(const vector& rhs) -> vector&
 {
+    if (can_hold_copy_of(rhs)) {
+        return copy_assign_in_place(rhs);
+    }
+    tidy();
+    base().assign(rhs.base(), rhs.copy_storage_size());
+    init_ptrs(rhs.capacity());
+    _align_max = rhs._align_max;
+    set_ptrs(rhs.poly_uninitialized_copy(base(), begin_elem(), _begin_storage, rhs.end_elem(),
+        rhs.capacity(), rhs.max_align()));
+    _stats = rhs._stats;
     return *this;
 }
 
-template <class IF, class Allocator, class CloningPolicy>
-inline auto vector<IF, Allocator, CloningPolicy>::poly_uninitialized_copy(my_base& a,
-    void_pointer dst_ptr, elem_ptr_const_pointer begin, elem_ptr_const_pointer _free,
-    elem_ptr_const_pointer end, size_t max_align) -> poly_copy_descr
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::copy_assign_in_place(const vector& rhs) -> vector&
 {
-    const auto   dst_begin     = static_cast<elem_ptr_pointer>(dst_ptr);
-    const auto   storage_begin = dst_begin + std::distance(begin, end);
-    auto         dst           = dst_begin;
-    void_pointer dst_storage   = storage_begin;
-    for (auto elem_dst = dst_begin; elem_dst != storage_begin; ++elem_dst) {
-        a.construct(elem_dst);
-    }
+    clear();
+    destroy_index_entries();
     try {
-        for (auto elem = begin; elem != _free; ++elem, ++dst) {
-            *dst           = *elem;
-            dst->ptr.first = next_aligned_storage(dst_storage, max_align);
-            dst->ptr.second
-                = elem->policy().clone(a.get_allocator_ref(), elem->ptr.second, dst->ptr.first);
-            dst_storage = static_cast<pointer>(dst->ptr.first) + dst->size();
-        }
-        return std::make_tuple(dst, storage_begin, dst_storage);
+        set_ptrs(rhs.poly_uninitialized_copy(base(), begin_elem(), _begin_storage, rhs.end_elem(),
+            capacity(), rhs.max_align()));
     } catch (...) {
-        while (dst-- != dst_begin) {
-            a.destroy(dst->ptr.second);
-        }
-        for (auto elem_dst = dst_begin; elem_dst != storage_begin; ++elem_dst) {
-            a.destroy(elem_dst);
+        for (auto i = begin_elem(); i != begin_elem() + capacity(); ++i) {
+            base().construct(i);
         }
         throw;
     }
+    _align_max = rhs._align_max;
+    _stats     = rhs._stats;
+    return *this;
 }
 
-template <class IF, class Allocator, class CloningPolicy>
-inline auto vector<IF, Allocator, CloningPolicy>::poly_uninitialized_move(my_base& a,
-    void_pointer dst_ptr, elem_ptr_const_pointer begin, elem_ptr_const_pointer _free,
-    elem_ptr_const_pointer end, size_t max_align) noexcept -> poly_copy_descr
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::copy_storage_size() const noexcept
 {
-    const auto   dst_begin     = static_cast<elem_ptr_pointer>(dst_ptr);
-    auto         dst           = dst_begin;
-    const auto   storage_begin = dst_begin + std::distance(begin, end);
-    void_pointer dst_storage   = storage_begin;
-    for (auto elem_dst = dst_begin; elem_dst != storage_begin; ++elem_dst) {
-        a.construct(elem_dst);
-    }
-    for (auto elem = begin; elem != _free; ++elem, ++dst) {
-        *dst            = *elem;
-        dst->ptr.first  = next_aligned_storage(dst_storage, max_align);
-        dst->ptr.second = cloning_policy_traits::move(
-            elem->policy(), a.get_allocator_ref(), elem->ptr.second, dst->ptr.first);
-        dst_storage = static_cast<pointer>(dst->ptr.first) + dst->size();
+    const auto size = static_cast<size_t>(base().size());
+    if (empty()) {
+        return size;
     }
-    return std::make_tuple(dst, storage_begin, dst_storage);
+    // the objects may be laid out again in index order from a storage of another alignment,
+    // which can take more padding than the current layout: the storage of an unordered vector
+    // is not laid out in index order, and objects inserted in place may have raised the max
+    // alignment above the one the storage was sized for
+    return std::max(
+        size, index_bytes(capacity()) + _align_max - 1 + storage_extent_estimate(_align_max));
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::copy_assign_impl(const vector& rhs) -> vector&
+template <class I, class A, class C, class L>
+inline bool vector<I, A, C, L>::can_hold_copy_of(const vector& rhs) const noexcept
 {
-    tidy();
-    base() = rhs.base();
-    init_ptrs(rhs.capacity());
-    _align_max = rhs._align_max;
-    set_ptrs(poly_uninitialized_copy(
-        base(), begin_elem(), rhs.begin_elem(), rhs.end_elem(), rhs.last_elem(), rhs.max_align()));
-    return *this;
+    // the copy is laid out from the beginning of the storage, which takes at most the
+    // alignment slack of a new allocation
+    const auto required = rhs._align_max - 1 + rhs.storage_extent_estimate(rhs._align_max);
+    return base().get_allocator_ref() == rhs.base().get_allocator_ref() && rhs.size() <= capacity()
+        && required <= storage_size(_begin_storage, base().end_storage());
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::move_assign_impl(vector&& rhs) noexcept -> vector&
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::move_assign_impl(vector&& rhs) noexcept -> vector&
 {
     using std::swap;
     base().swap_with_propagate(
         rhs.base(), typename my_base::propagate_on_container_move_assignment {});
     swap_ptrs(std::move(rhs));
     swap(_align_max, rhs._align_max);
+    swap(_stats, rhs._stats);
     return *this;
 }
 
-template <class I, class A, class C> inline void vector<I, A, C>::tidy() noexcept
+template <class I, class A, class C, class L> inline void vector<I, A, C, L>::tidy() noexcept
 {
     clear();
-    for (auto i = begin_elem(); i != begin_elem() + capacity(); ++i) {
-        base().destroy(i);
-    }
+    destroy_index_entries();
+    release_index();
     _begin_storage = _free_elem = nullptr;
+    _free_storage               = nullptr;
     my_base::tidy();
 }
 
-template <class I, class A, class C>
-inline void vector<I, A, C>::destroy_elem(elem_ptr_pointer p) noexcept
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::destroy_index_entries() noexcept
 {
-    base().destroy(p->ptr.second);
+    /*constexpr*/ if (!std::is_trivially_destructible<elem_ptr>::value) {
+        for (auto i = begin_elem(); i != begin_elem() + capacity(); ++i) {
+            base().destroy(i);
+        }
+    }
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::destroy_elem(elem_ptr_pointer p) noexcept
+{
+    cloning_policy_traits::destroy(
+        p->policy(), base().get_allocator_ref(), p->object(_begin_storage));
+    _stats.remove(
+        p->size(), p->align(), cloning_policy_traits::trivially_destructible(p->policy()));
     *p = elem_ptr();
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::destroy_range(elem_ptr_pointer first, elem_ptr_pointer last) noexcept
-    -> std::pair<void_pointer, void_pointer>
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::destroy_range(
+    elem_ptr_pointer first, elem_ptr_pointer last) noexcept -> std::pair<void_pointer, void_pointer>
 {
     std::pair<void_pointer, void_pointer> ret {};
     if (first != last) {
-        ret.first  = first->ptr.first;
-        ret.second = last != end_elem() ? last->ptr.first : base().end_storage();
+        ret.first  = first->storage(_begin_storage);
+        ret.second = last != end_elem() ? last->storage(_begin_storage) : base().end_storage();
+    }
+    // nothing to destroy when every object is trivially destructible, by the policy or by the
+    // flags of their types, emptying the container only forgets its objects
+    if ((trivially_destructible_elements::value || _stats.trivially_destructible())
+        && first == begin_elem() && last == end_elem()) {
+        _stats = storage_accounting {};
+        return ret;
     }
     for (; first != last; ++first) {
+        // in an unordered layout the storage of the objects stays between the others
+        const auto storage = first->storage(_begin_storage);
+        const auto end     = storage_end(first);
         destroy_elem(first);
+        if (!_address_ordered) {
+            _holes.add(storage, end);
+        }
     }
     return ret;
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::erase_internal_range(elem_ptr_pointer first, elem_ptr_pointer last)
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::erase_internal_range(elem_ptr_pointer first, elem_ptr_pointer last)
     -> iterator
 {
     assert(first != last);
     assert(last != end_elem());
     using std::swap;
-    auto return_iterator = first;
-    auto free_range      = destroy_range(first, last);
-    for (; last != end_elem()
-         && occupied_storage(last) <= storage_size(free_range.first, free_range.second);
-         ++last, ++first) {
+    auto         return_iterator = first;
+    auto         free_begin      = destroy_range(first, last).first;
+    void_pointer run_first {};
+    void_pointer run_last {};
+    void_pointer run_dst {};
+    void_pointer gap_end {};
+    if (_address_ordered) {
+        _holes.forget_from(free_begin);
+    }
+    // an unordered layout only drops the index entries, their storage is left to the holes
+    for (; _address_ordered && last != end_elem(); ++last, ++first) {
+        // objects are moved backward as long as they do not overlap with their old storage
+        auto dst     = next_aligned_storage(free_begin, placement_align(last->align()));
+        auto storage = last->storage(_begin_storage);
+        if (storage_size(dst, storage) < last->size()) {
+            gap_end = storage;
+            break;
+        }
+        if (trivially_relocatable(last)) {
+            if (run_last != storage
+                || storage_size(run_dst, dst) != storage_size(run_first, run_last)) {
+                relocate_bytes(run_dst, run_first, run_last);
+                run_first = storage;
+                run_dst   = dst;
+            }
+            run_last   = static_cast<pointer>(storage) + last->size();
+            auto clone = rebased_object(*last, _begin_storage, dst);
+            swap(*first, *last);
+            first->place(_begin_storage, dst, clone);
+            free_begin = static_cast<pointer>(dst) + first->size();
+            continue;
+        }
+        relocate_bytes(run_dst, run_first, run_last);
+        run_first = run_last = run_dst = nullptr;
         try {
-            auto clone = cloning_policy_traits::move(
-                last->policy(), base().get_allocator_ref(), last->ptr.second, free_range.first);
-            base().destroy(last->ptr.second);
+            auto clone = cloning_policy_traits::move(last->policy(), base().get_allocator_ref(),
+                last->object(_begin_storage), dst);
+            cloning_policy_traits::destroy(
+                last->policy(), base().get_allocator_ref(), last->object(_begin_storage));
             swap(*first, *last);
-            first->ptr = std::make_pair(free_range.first, clone);
-            free_range = std::make_pair(
-                next_aligned_storage(
-                    static_cast<pointer>(free_range.first) + first->size(), _align_max),
-                next_aligned_storage(
-                    static_cast<pointer>(free_range.second) + first->size(), _align_max));
+            first->place(_begin_storage, dst, clone);
+            free_begin = static_cast<pointer>(dst) + first->size();
         } catch (...) {
             destroy_range(last, end_elem());
-            _free_elem = first;
+            _free_elem    = first;
+            _free_storage = last_storage_end();
             throw;
         }
     }
+    relocate_bytes(run_dst, run_first, run_last);
+    if (gap_end) {
+        _holes.add(free_begin, gap_end);
+    }
     for (; last != end_elem(); ++last, ++first) {
         swap(*first, *last);
     }
     _free_elem = first;
-    return iterator(return_iterator);
+    if (_address_ordered) {
+        _free_storage = last_storage_end();
+    }
+    return iterator(return_iterator, _begin_storage);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::clear_till_end(elem_ptr_pointer first) noexcept -> iterator
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::clear_till_end(elem_ptr_pointer first) noexcept -> iterator
 {
+    // in an unordered layout the free storage only shrinks below objects that end it
+    const auto old_free = _free_storage;
+    auto       free     = _free_storage;
+    for (auto p = _free_elem; !_address_ordered && first != begin_elem() && p != first;) {
+        if (storage_end(--p) == free) {
+            free = p->storage(_begin_storage);
+        }
+    }
     destroy_range(first, _free_elem);
-    _free_elem = first;
+    _free_elem       = first;
+    _address_ordered = _address_ordered || empty();
+    _free_storage    = _address_ordered ? last_storage_end() : free;
+    if (empty()) {
+        _holes.clear();
+    } else if (_free_storage != old_free) {
+        _holes.forget_from(_free_storage);
+    }
     return end();
 }
 
-template <class I, class A, class C> inline void vector<I, A, C>::set_ptrs(poly_copy_descr p)
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::set_ptrs(poly_copy_descr p)
 {
-    _free_elem     = std::get<0>(p);
-    _begin_storage = std::get<1>(p);
+    _free_elem       = std::get<0>(p);
+    _begin_storage   = std::get<1>(p);
+    _free_storage    = std::get<2>(p);
+    _address_ordered = true;
+    _holes.clear();
+    _defrag_cursor.reset();
 }
 
-template <class I, class A, class C> inline void vector<I, A, C>::swap_ptrs(vector&& rhs)
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::swap_ptrs(vector&& rhs)
 {
     using std::swap;
+    this->swap_index(rhs);
     swap(_free_elem, rhs._free_elem);
     swap(_begin_storage, rhs._begin_storage);
+    swap(_free_storage, rhs._free_storage);
+    swap(_address_ordered, rhs._address_ordered);
+    swap(_holes, rhs._holes);
+    swap(_defrag_cursor, rhs._defrag_cursor);
 }
 
-template <class I, class A, class C>
+template <class I, class A, class C, class L>
 template <class T, typename... Args>
-inline void vector<I, A, C>::push_back_new_elem(type_tag<T> /* t */, Args&&... args)
+inline void vector<I, A, C, L>::insert_new_elem(size_t pos, type_tag<T> /* t */, Args&&... args)
 {
     constexpr auto s = sizeof(T);
     constexpr auto a = alignof(T);
-    using traits     = typename allocator_traits ::template rebind_traits<T>;
 
     assert(can_construct_new_elem(s, a));
+    // the object always goes to the free storage, only the entries after pos are shifted
+    const auto nas     = next_aligned_storage(placement_align(a));
+    const auto ordered = _address_ordered && pos == size();
+    construct_new_elem(nas, pos, type_tag<T> {}, std::forward<Args>(args)...);
+    _address_ordered = ordered;
+    _free_storage    = static_cast<pointer>(nas) + s;
+}
+
+template <class I, class A, class C, class L>
+template <class T, typename... Args>
+inline bool vector<I, A, C, L>::insert_new_elem_into_hole(
+    size_t pos, type_tag<T> /* t */, Args&&... args)
+{
+    constexpr auto s = sizeof(T);
+    constexpr auto a = alignof(T);
+    if (end_elem() == index_end() || a > _align_max) {
+        return false;
+    }
+    const auto size = vector_impl::padded_size(s, placement_align(a));
+    const auto hole = _holes.take(size, placement_align(a));
+    if (!hole) {
+        return false;
+    }
+    try {
+        construct_new_elem(hole, pos, type_tag<T> {}, std::forward<Args>(args)...);
+    } catch (...) {
+        _holes.add(hole, static_cast<pointer>(hole) + size);
+        throw;
+    }
+    _address_ordered = false;
+    return true;
+}
+
+template <class I, class A, class C, class L>
+template <class T, typename... Args>
+inline void vector<I, A, C, L>::construct_new_elem(
+    void_pointer storage, size_t pos, type_tag<T> /* t */, Args&&... args)
+{
+    constexpr auto s = sizeof(T);
+    constexpr auto a = alignof(T);
+    using traits     = typename allocator_traits ::template rebind_traits<T>;
+
+    assert(end_elem() != index_end());
     assert(_align_max >= a);
-    auto nas = next_aligned_storage(_align_max);
-    auto obj_ptr
-        = base().construct(static_cast<typename traits::pointer>(nas), std::forward<Args>(args)...);
-    *_free_elem = elem_ptr(type_tag<T> {}, nas, obj_ptr);
+    assert(pos <= size());
+    auto obj_ptr = base().construct(
+        static_cast<typename traits::pointer>(storage), std::forward<Args>(args)...);
+    if (!elem_ptr::representable(storage, obj_ptr)) {
+        base().destroy(obj_ptr);
+        throw std::length_error("poly::vector index cannot represent the object layout");
+    }
+    const auto elem = begin_elem() + pos;
+    std::move_backward(elem, _free_elem, _free_elem + 1);
+    *elem = elem_ptr(type_tag<T> {});
+    elem->place(_begin_storage, storage, obj_ptr);
     ++_free_elem;
+    _stats.add(s, a, cloning_policy_traits::trivially_destructible(elem->policy()));
+}
+
+template <class I, class A, class C, class L>
+template <class T, typename... Args>
+inline void vector<I, A, C, L>::insert_new_elem_w_storage_increase(
+    size_t pos, type_tag<T> /* t */, Args&&... args)
+{
+    // storage freed between the objects is used before growing, the arguments are only
+    // consumed when a fitting hole is found
+    if (insert_new_elem_into_hole(pos, type_tag<T> {}, std::forward<Args>(args)...)) {
+        return;
+    }
+    insert_new_elem_w_storage_increase(
+        separate_index {}, pos, type_tag<T> {}, std::forward<Args>(args)...);
+}
+
+template <class I, class A, class C, class L>
+template <class T, typename... Args>
+inline void vector<I, A, C, L>::insert_new_elem_w_storage_increase(
+    std::true_type /*unused*/, size_t pos, type_tag<T> /* t */, Args&&... args)
+{
+    constexpr auto s                = sizeof(T);
+    constexpr auto a                = alignof(T);
+    constexpr auto noexcept_movable = interface_type_noexcept_movable::value;
+    constexpr auto nothrow_ctor     = std::is_nothrow_constructible<T, Args...>::value;
+    using copy = std::integral_constant<bool, !(noexcept_movable && nothrow_ctor)>;
+    //////////////////////////////////////////
+    // the index and the objects grow independently of each other
+    if (end_elem() == index_end()) {
+        reallocate_index(std::max(capacity() * 2, size_t(1)));
+    }
+    if (!can_construct_new_elem(s, a)) {
+        const auto sizes = calculate_storage_size(capacity(), s, a);
+        check_storage_size(sizes.first);
+        my_base storage(sizes.first,
+            allocator_traits::select_on_container_copy_construction(base().get_allocator_ref()));
+        obtain_storage(std::move(storage), capacity(), sizes.second, copy {});
+    }
+    insert_new_elem(pos, type_tag<T> {}, std::forward<Args>(args)...);
 }
 
-template <class I, class A, class C>
+template <class I, class A, class C, class L>
 template <class T, typename... Args>
-inline void vector<I, A, C>::push_back_new_elem_w_storage_increase(
-    type_tag<T> /* t */, Args&&... args)
+inline void vector<I, A, C, L>::insert_new_elem_w_storage_increase(
+    std::false_type /*unused*/, size_t pos, type_tag<T> /* t */, Args&&... args)
 {
     constexpr auto s                = sizeof(T);
     constexpr auto a                = alignof(T);
@@ -1469,46 +3677,56 @@ inline void vector<I, A, C>::push_back_new_elem_w_storage_increase(
     const auto sizes        = calculate_storage_size(new_capacity, s, a);
     vector v(allocator_traits::select_on_container_copy_construction(base().get_allocator_ref()));
     v.init_layout(sizes.first, new_capacity, sizes.second);
-    push_back_new_elem_w_storage_increase_copy(
-        v, std::integral_constant < bool, noexcept_movable&& nothrow_ctor > {});
-    v.push_back_new_elem(type_tag<T> {}, std::forward<Args>(args)...);
-    this->swap(v);
+    insert_new_elem_w_storage_increase_impl(v,
+        std::integral_constant<bool, noexcept_movable && nothrow_ctor> {}, pos, type_tag<T> {},
+        std::forward<Args>(args)...);
 }
 
-template <class I, class A, class C>
-inline void vector<I, A, C>::push_back_new_elem_w_storage_increase_copy(
-    vector& v, std::true_type /*unused*/)
+template <class I, class A, class C, class L>
+template <class T, typename... Args>
+inline void vector<I, A, C, L>::insert_new_elem_w_storage_increase_impl(
+    vector& v, std::true_type /*unused*/, size_t pos, type_tag<T> /* t */, Args&&... args)
 {
-    v.set_ptrs(poly_uninitialized_move(base(), v.begin_elem(), begin_elem(), end_elem(),
-        std::next(begin_elem(), v.capacity()), v.max_align()));
+    // the elements are relocated first, so they stay in the container even if the new one
+    // cannot be added
+    const auto stats = _stats;
+    v.set_ptrs(poly_uninitialized_relocate(v.base(), v.begin_elem(), v._begin_storage, end_elem(),
+        v.capacity(), v.max_align()));
+    v._stats = stats;
+    this->swap(v);
+    insert_new_elem(pos, type_tag<T> {}, std::forward<Args>(args)...);
 }
 
-template <class I, class A, class C>
-inline void vector<I, A, C>::push_back_new_elem_w_storage_increase_copy(
-    vector& v, std::false_type /*unused*/)
+template <class I, class A, class C, class L>
+template <class T, typename... Args>
+inline void vector<I, A, C, L>::insert_new_elem_w_storage_increase_impl(
+    vector& v, std::false_type /*unused*/, size_t pos, type_tag<T> /* t */, Args&&... args)
 {
-    v.set_ptrs(poly_uninitialized_copy(v.base(), v.begin_elem(), begin_elem(), _free_elem,
-        std::next(begin_elem(), v.capacity()), v.max_align()));
+    v.set_ptrs(poly_uninitialized_copy(v.base(), v.begin_elem(), v._begin_storage, _free_elem,
+        v.capacity(), v.max_align()));
+    v._stats = _stats;
+    v.insert_new_elem(pos, type_tag<T> {}, std::forward<Args>(args)...);
+    this->swap(v);
 }
 
-template <class I, class A, class C>
-inline bool vector<I, A, C>::can_construct_new_elem(size_t s, size_t align) noexcept
+template <class I, class A, class C, class L>
+inline bool vector<I, A, C, L>::can_construct_new_elem(size_t s, size_t align) noexcept
 {
-    if (end_elem() == _begin_storage || align > _align_max) {
+    if (end_elem() == index_end() || align > _align_max) {
         return false;
     }
-    auto free = static_cast<pointer>(next_aligned_storage(free_storage(), _align_max));
+    auto free = static_cast<pointer>(next_aligned_storage(free_storage(), placement_align(align)));
     return free + s <= this->end_storage();
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::next_aligned_storage(size_t align) const noexcept -> void_pointer
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::next_aligned_storage(size_t align) const noexcept -> void_pointer
 {
     return next_aligned_storage(free_storage(), align);
 }
 
-template <class I, class A, class C>
-inline size_t vector<I, A, C>::avg_obj_size(size_t align) const noexcept
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::avg_obj_size(size_t align) const noexcept
 {
     return !empty()
         ? (static_cast<size_t>(storage_size(_begin_storage, next_aligned_storage(align))) + size()
@@ -1517,126 +3735,466 @@ inline size_t vector<I, A, C>::avg_obj_size(size_t align) const noexcept
         : 0;
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::begin_elem() noexcept -> elem_ptr_pointer
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::index_begin() const noexcept -> void_pointer
+{
+    return index_begin(separate_index {});
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::index_begin(std::false_type /*unused*/) const noexcept
+    -> void_pointer
+{
+    return this->_storage;
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::index_begin(std::true_type /*unused*/) const noexcept
+    -> void_pointer
+{
+    return this->_index;
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::index_end() const noexcept -> void_pointer
+{
+    return index_end(separate_index {});
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::index_end(std::false_type /*unused*/) const noexcept
+    -> void_pointer
+{
+    return _begin_storage;
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::index_end(std::true_type /*unused*/) const noexcept
+    -> void_pointer
+{
+    return this->_end_index;
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::begin_elem() noexcept -> elem_ptr_pointer
 {
-    return static_cast<elem_ptr_pointer>(this->storage());
+    return static_cast<elem_ptr_pointer>(index_begin());
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::cbegin_elem() const noexcept -> elem_ptr_const_pointer
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::cbegin_elem() const noexcept -> elem_ptr_const_pointer
 {
     return begin_elem();
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::end_elem() noexcept -> elem_ptr_pointer
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::end_elem() noexcept -> elem_ptr_pointer
 {
     return static_cast<elem_ptr_pointer>(_free_elem);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::begin_elem() const noexcept -> elem_ptr_const_pointer
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::begin_elem() const noexcept -> elem_ptr_const_pointer
 {
-    return static_cast<elem_ptr_const_pointer>(this->storage());
+    return static_cast<elem_ptr_const_pointer>(index_begin());
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::end_elem() const noexcept -> elem_ptr_const_pointer
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::end_elem() const noexcept -> elem_ptr_const_pointer
 {
     return static_cast<elem_ptr_const_pointer>(_free_elem);
 }
 
-template <class IF, class Allocator, class CloningPolicy>
-inline auto vector<IF, Allocator, CloningPolicy>::last_elem() const noexcept
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::last_elem() const noexcept
     -> elem_ptr_const_pointer
 {
     return static_cast<elem_ptr_const_pointer>(_begin_storage);
 }
 
-template <class IF, class Allocator, class CloningPolicy>
-inline auto vector<IF, Allocator, CloningPolicy>::free_storage() const noexcept -> void_pointer
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::free_storage() const noexcept
+    -> void_pointer
+{
+    return _free_storage;
+}
+
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::last_storage_end() const noexcept
+    -> void_pointer
 {
-    if (_free_elem == this->storage()) {
+    if (_free_elem == begin_elem()) {
         return this->_begin_storage;
     }
-    const auto prev_elem = std::prev(_free_elem);
-    return static_cast<pointer>(prev_elem->ptr.first) + prev_elem->size();
+    return storage_end(std::prev(_free_elem));
+}
+
+template <class IF, class Allocator, class CloningPolicy, class Layout>
+inline auto vector<IF, Allocator, CloningPolicy, Layout>::storage_end(
+    elem_ptr_const_pointer p) const noexcept -> void_pointer
+{
+    return static_cast<pointer>(p->storage(_begin_storage)) + p->size();
+}
+
+template <class I, class A, class C, class L> inline void vector<I, A, C, L>::init_ptrs(size_t cap)
+{
+    init_ptrs(cap, separate_index {});
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::init_ptrs(size_t cap, std::false_type /*unused*/) noexcept
+{
+    _free_elem       = begin_elem();
+    _begin_storage   = begin_elem() + cap;
+    _free_storage    = _begin_storage;
+    _address_ordered = true;
+    _holes.clear();
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::init_ptrs(size_t cap, std::true_type /*unused*/)
+{
+    const auto index = allocate_index(cap);
+    release_index();
+    this->_index     = index;
+    this->_end_index = index + cap;
+    _free_elem       = begin_elem();
+    _begin_storage   = this->storage();
+    _free_storage    = _begin_storage;
+    _address_ordered = true;
+    _holes.clear();
+}
+
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::index_bytes(size_t n) noexcept
+{
+    return separate_index::value ? 0 : n * sizeof(elem_ptr);
+}
+
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::allocate_index(size_t n) -> elem_ptr_pointer
+{
+    if (n == 0) {
+        return nullptr;
+    }
+    return static_cast<elem_ptr_pointer>(static_cast<void_pointer>(
+        base().get_allocator_ref().allocate(n * sizeof(elem_ptr))));
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::deallocate_index(elem_ptr_pointer p, size_t n) noexcept
+{
+    if (p) {
+        base().get_allocator_ref().deallocate(
+            static_cast<pointer>(static_cast<void_pointer>(p)), n * sizeof(elem_ptr));
+    }
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::release_index() noexcept
+{
+    release_index(separate_index {});
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::release_index(std::false_type /*unused*/) noexcept
+{
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::release_index(std::true_type /*unused*/) noexcept
+{
+    deallocate_index(begin_elem(), capacity());
+    this->_index = this->_end_index = nullptr;
 }
 
-template <class I, class A, class C> inline void vector<I, A, C>::init_ptrs(size_t cap) noexcept
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::reallocate_index(size_t n)
 {
-    _free_elem     = begin_elem();
-    _begin_storage = begin_elem() + cap;
+    assert(n >= size());
+    // the entries do not depend on their own location, the objects stay where they are
+    const auto index = allocate_index(n);
+    const auto sz    = size();
+    for (auto i = index; i != index + n; ++i) {
+        base().construct(i);
+    }
+    std::copy(begin_elem(), end_elem(), index);
+    destroy_index_entries();
+    release_index();
+    this->_index     = index;
+    this->_end_index = index + n;
+    _free_elem       = index + sz;
 }
 
-template <class I, class A, class C>
-inline std::pair<size_t, size_t> vector<I, A, C>::calculate_storage_size(
+template <class I, class A, class C, class L>
+inline std::pair<size_t, size_t> vector<I, A, C, L>::calculate_storage_size(
     size_t new_size, size_t new_elem_size, size_t new_alignment) const noexcept
 {
     const auto max_alignment            = std::max(new_alignment, max_align());
     const auto initial_alignment_buffer = max_alignment;
+    const auto buffer_size = initial_alignment_buffer + storage_extent_estimate(max_alignment);
     const auto new_object_size
-        = ((new_elem_size + max_alignment - 1) / max_alignment) * max_alignment;
-    const auto buffer_size = std::accumulate(begin_elem(), end_elem(), initial_alignment_buffer,
-        [max_alignment](size_t val, const auto& p) {
-            return val + ((p.size() + max_alignment - 1) / max_alignment) * max_alignment;
-        });
+        = packing_policy::appended_size(new_elem_size, new_alignment, max_alignment);
     auto       avg_obj_size
         = !empty() ? (buffer_size + new_object_size + size()) / (size() + 1) : new_object_size;
     auto num_of_new_obj = new_size >= size() ? (new_size - size()) : 0U;
-    auto size           = new_size * sizeof(elem_ptr) + // storage for ptrs
+    auto size           = index_bytes(new_size) + // storage for ptrs
         buffer_size + // storage for existing elems w initial alignment
         new_object_size + // storage for the new elem
         (num_of_new_obj * avg_obj_size); // estimated storage for new elems
     return std::make_pair(size, max_alignment);
 }
 
-template <class I, class A, class C>
-inline auto vector<I, A, C>::occupied_storage(elem_ptr_const_pointer p) const noexcept -> size_type
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::storage_extent(size_t max_alignment) const noexcept
+{
+    return storage_extent(begin_elem(), end_elem(), 0, max_alignment);
+}
+
+template <class I, class A, class C, class L>
+template <class InputIt>
+inline size_t vector<I, A, C, L>::storage_extent(
+    InputIt first, InputIt last, size_t offset, size_t max_alignment) noexcept
+{
+    return std::accumulate(first, last, offset, [max_alignment](size_t val, const auto& p) {
+        return packing_policy::next_offset(val, p.size(), p.align(), max_alignment);
+    });
+}
+
+template <class I, class A, class C, class L>
+template <class InputIt>
+inline std::pair<size_t, size_t> vector<I, A, C, L>::range_storage_size(
+    InputIt first, InputIt last) const noexcept
+{
+    const auto n     = size() + static_cast<size_t>(last - first);
+    const auto align = std::accumulate(first, last, _align_max,
+        [](size_t val, const auto& p) { return std::max(val, p.align()); });
+    auto extent = align - 1 + storage_extent(first, last, storage_extent(align), align);
+    if (elem_ptr::is_relative::value && _address_ordered && align == _align_max && !empty()) {
+        // the current objects might keep their offsets, the range is appended behind them
+        const auto mis  = misalignment(_begin_storage, align);
+        const auto free = next_aligned_storage(
+            free_storage(), packing_policy::placement_align(1, align));
+        const auto used = mis + storage_size(_begin_storage, free);
+        extent          = std::max(extent, storage_extent(first, last, used, align) - mis);
+    }
+    return std::make_pair(index_bytes(n) + extent, align);
+}
+
+template <class I, class A, class C, class L>
+template <class InputIt>
+inline bool vector<I, A, C, L>::can_append_range(InputIt first, InputIt last) const noexcept
+{
+    if (capacity() - size() < static_cast<size_t>(last - first)) {
+        return false;
+    }
+    auto free = static_cast<pointer>(free_storage());
+    for (; first != last; ++first) {
+        if (first->align() > _align_max) {
+            return false;
+        }
+        free = static_cast<pointer>(next_aligned_storage(free, placement_align(first->align())))
+            + first->size();
+    }
+    return free <= this->end_storage();
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::append_range(
+    elem_ptr_const_pointer first, elem_ptr_const_pointer last, void_pointer base)
+{
+    assert(can_append_range(first, last));
+    const auto old_end     = _free_elem;
+    const auto old_free    = _free_storage;
+    const auto old_ordered = _address_ordered;
+    try {
+        for (; first != last; ++first) {
+            auto ns  = next_aligned_storage(placement_align(first->align()));
+            auto obj = first->policy().clone(
+                this->base().get_allocator_ref(), first->object(base), ns);
+            *_free_elem = *first;
+            _free_elem->place(_begin_storage, ns, obj);
+            ++_free_elem;
+            _free_storage = static_cast<pointer>(ns) + first->size();
+            _stats.add(first->size(), first->align(),
+                cloning_policy_traits::trivially_destructible(first->policy()));
+        }
+    } catch (...) {
+        rollback_append(old_end, old_free, old_ordered);
+        throw;
+    }
+}
+
+template <class I, class A, class C, class L>
+template <class InputIt>
+inline void vector<I, A, C, L>::make_room_for_range(InputIt first, InputIt last)
+{
+    using copy = std::conditional_t<interface_type_noexcept_movable::value, std::false_type,
+        std::true_type>;
+    if (can_append_range(first, last)) {
+        return;
+    }
+    const auto sizes = range_storage_size(first, last);
+    check_storage_size(sizes.first);
+    my_base s(sizes.first,
+        allocator_traits::select_on_container_copy_construction(base().get_allocator_ref()));
+    obtain_storage(std::move(s), size() + static_cast<size_t>(std::distance(first, last)),
+        sizes.second, copy {});
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::rollback_append(
+    elem_ptr_pointer end, void_pointer free, bool ordered) noexcept
+{
+    destroy_range(end, _free_elem);
+    _free_elem       = end;
+    _free_storage    = free;
+    _address_ordered = ordered;
+    _holes.forget_from(free);
+}
+
+template <class I, class A, class C, class L>
+template <class T, class Tuple, size_t... Is>
+inline void vector<I, A, C, L>::emplace_back_from_tuple(
+    Tuple&& args, std::index_sequence<Is...> /*unused*/)
+{
+    insert_new_elem(size(), type_tag<T> {}, std::get<Is>(std::forward<Tuple>(args))...);
+}
+
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::storage_extent_estimate(size_t max_alignment) const noexcept
+{
+    return storage_extent_estimate(max_alignment, typename packing_policy::pads_to_max_align {});
+}
+
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::storage_extent_estimate(
+    size_t max_alignment, std::true_type /*unused*/) const noexcept
+{
+    /*constexpr*/ if (tracking_policy::per_align_class::value) {
+        return _stats.padded_extent(max_alignment);
+    }
+    // the bound kept without the totals per alignment class pads every object by the whole
+    // alignment, the storage is only sized on reallocation, which walks the objects anyway
+    return storage_extent(max_alignment);
+}
+
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::storage_extent_estimate(
+    size_t max_alignment, std::false_type /*unused*/) const noexcept
+{
+    if (empty()) {
+        return 0;
+    }
+    if (!_address_ordered) {
+        return _stats.natural_extent_bound();
+    }
+    // either the current layout moved to a max_alignment boundary or the worst case padding
+    const auto first = begin_elem()->storage(_begin_storage);
+    return std::min(_stats.natural_extent_bound(),
+        misalignment(first, max_alignment) + storage_size(first, free_storage()));
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::account(
+    elem_ptr_const_pointer first, elem_ptr_const_pointer last) noexcept
+{
+    for (; first != last; ++first) {
+        _stats.add(first->size(), first->align(),
+            cloning_policy_traits::trivially_destructible(first->policy()));
+    }
+}
+
+template <class I, class A, class C, class L>
+inline size_t vector<I, A, C, L>::placement_align(size_t align) const noexcept
 {
-    return ((p->size() + _align_max - 1) / _align_max) * _align_max;
+    return packing_policy::placement_align(align, _align_max);
 }
 
-template <class I, class A, class C>
+template <class I, class A, class C, class L>
 template <class descendant_type>
-inline auto vector<I, A, C>::insert(const_iterator position, descendant_type&& val)
+inline auto vector<I, A, C, L>::insert(const_iterator position, descendant_type&& val)
     -> std::enable_if_t<std::is_base_of<interface_type, std::decay_t<descendant_type>>::value,
         iterator>
 {
-    if (position == end()) {
-        push_back(std::forward<descendant_type>(val));
-        return std::prev(end());
+    using TT           = std::decay_t<descendant_type>;
+    constexpr auto s   = sizeof(TT);
+    constexpr auto a   = alignof(TT);
+    const auto     pos = static_cast<size_t>(std::distance(cbegin(), position));
+    if (!can_construct_new_elem(s, a)) {
+        insert_new_elem_w_storage_increase(
+            pos, type_tag<TT> {}, std::forward<descendant_type>(val));
+    } else {
+        insert_new_elem(pos, type_tag<TT> {}, std::forward<descendant_type>(val));
     }
-    using TT         = std::decay_t<descendant_type>;
-    constexpr auto s = sizeof(TT);
-    constexpr auto a = alignof(TT);
-    //////////////////////////////////////////
-    const auto new_index = std::distance(cbegin(), position);
-    const auto new_size  = size() + 1;
-    const auto sizes     = calculate_storage_size(new_size, s, a);
-    auto       from      = std::next(begin_elem(), new_index);
+    return std::next(begin(), static_cast<std::ptrdiff_t>(pos));
+}
 
-    vector v(allocator_traits::select_on_container_copy_construction(base().get_allocator_ref()));
-    v.init_layout(sizes.first, new_size, sizes.second);
-    v.set_ptrs(poly_uninitialized_copy(v.base(), v.begin_elem(), begin_elem(), from,
-        std::next(cbegin_elem(), new_size), v.max_align()));
-    v.push_back(std::forward<descendant_type>(val));
-
-    auto dst_storage = v.free_storage();
-    auto dst         = v.end_elem();
-
-    for (; from != end_elem(); ++from, ++dst) {
-        *dst           = *from;
-        dst->ptr.first = next_aligned_storage(dst_storage, v.max_align());
-        dst->ptr.second
-            = from->policy().clone(v.base().get_allocator_ref(), from->ptr.second, dst->ptr.first);
-        dst_storage  = static_cast<pointer>(dst->ptr.first) + dst->size();
-        v._free_elem = dst;
-    }
-    v._free_elem = dst;
-    this->swap(v);
-    return std::next(begin(), new_index);
+template <class I, class A, class C, class L>
+inline auto vector<I, A, C, L>::insert(
+    const_iterator position, const_iterator first, const_iterator last) -> iterator
+{
+    const auto pos      = static_cast<size_t>(std::distance(cbegin(), position));
+    const auto old_size = size();
+    make_room_for_range(first.get(), last.get());
+    append_range(first.get(), last.get(), first.storage_base());
+    if (pos != old_size && first != last) {
+        std::rotate(begin_elem() + pos, begin_elem() + old_size, end_elem());
+        _address_ordered = false;
+    }
+    return iterator(begin_elem() + pos, _begin_storage);
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::append(const_iterator first, const_iterator last)
+{
+    insert(cend(), first, last);
+}
+
+template <class I, class A, class C, class L>
+inline void vector<I, A, C, L>::assign(const_iterator first, const_iterator last)
+{
+    clear();
+    insert(cend(), first, last);
+}
+
+template <class I, class A, class C, class L>
+template <typename... T, typename... Tuples>
+inline void vector<I, A, C, L>::emplace_back_all(Tuples&&... args)
+{
+    static_assert(sizeof...(T) == sizeof...(Tuples), "one tuple of arguments is needed per type");
+    static_assert(
+        vector_impl::and_type_t<typename std::is_base_of<interface_type, T>::type...>::value,
+        "every type must implement the interface");
+    using expand = int[];
+    if (!this->storage() && capacity() == 0) {
+        init_layout_for<T...>();
+    } else {
+        constexpr std::array<vector_impl::object_layout, sizeof...(T)> layouts { {
+            { sizeof(T), alignof(T) }... } };
+        make_room_for_range(layouts.begin(), layouts.end());
+    }
+    const auto old_end     = _free_elem;
+    const auto old_free    = _free_storage;
+    const auto old_ordered = _address_ordered;
+    try {
+        (void)expand { 0,
+            (emplace_back_from_tuple<T>(std::forward<Tuples>(args),
+                 std::make_index_sequence<std::tuple_size<std::decay_t<Tuples>>::value> {}),
+                0)... };
+    } catch (...) {
+        rollback_append(old_end, old_free, old_ordered);
+        throw;
+    }
+}
+
+/// creates a vector of the objects with a single allocation sized exactly for them at compile time
+template <class IF, class Allocator = std::allocator<IF>,
+    class CloningPolicy = delegate_cloning_policy<IF, Allocator>,
+    class Layout = vector_layout<pointer_index>, class... T>
+vector<IF, Allocator, CloningPolicy, Layout> make_poly_vector(T&&... objs)
+{
+    return vector<IF, Allocator, CloningPolicy, Layout>(std::forward<T>(objs)...);
 }
 
 } // namespace poly
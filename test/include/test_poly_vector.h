@@ -157,7 +157,8 @@ public:
     }
 
     Impl2T(Impl2T&& o) noexcept
-        : v { std::move(o.v) }
+        : Interface(std::move(o))
+        , v { std::move(o.v) }
         , p { std::move(o.p) }
     {
         cookie.set();
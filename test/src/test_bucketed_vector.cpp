@@ -0,0 +1,121 @@
+#include "catch_ext.hpp"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <vector>
+
+#include "test_poly_vector.h"
+#include <poly/bucketed_vector.h>
+
+TEST_CASE("bucketed vector groups the objects by their type", "[bucketed_vector]")
+{
+    using bucketed_vector = poly::bucketed_vector<Interface>;
+    using Impl3           = Impl2T<poly::delegate_cloning_policy<Interface>>;
+
+    bucketed_vector     v;
+    std::vector<size_t> impl1_ids;
+    size_t              impl2_count = 0;
+    for (auto i = 0; i < 64; ++i) {
+        if (i % 3 == 1) {
+            v.push_back(Impl2());
+            ++impl2_count;
+        } else {
+            impl1_ids.push_back(v.emplace_back<Impl1>(i).getId());
+        }
+    }
+    REQUIRE(v.size() == 64);
+    REQUIRE(v.buckets() == 2);
+    REQUIRE(v.count<Impl1>() == impl1_ids.size());
+    REQUIRE(v.count<Impl2>() == impl2_count);
+    REQUIRE(v.count<Impl3>() == 0);
+
+    SECTION("for_each visits the buckets one after the other")
+    {
+        std::vector<bool> is_impl2;
+        v.for_each([&](Interface& obj) { is_impl2.push_back(dynamic_cast<Impl2*>(&obj)); });
+        REQUIRE(is_impl2.size() == 64);
+        REQUIRE(std::is_partitioned(is_impl2.begin(), is_impl2.end(), [](bool b) { return !b; }));
+    }
+    SECTION("for_each_as passes the listed types statically")
+    {
+        std::vector<size_t> ids;
+        size_t              others = 0;
+        const auto&         cv     = v;
+        cv.for_each_as<Impl1>([&](const auto& obj) {
+            using T = std::decay_t<decltype(obj)>;
+            if (std::is_same<T, Impl1>::value) {
+                ids.push_back(obj.getId());
+            } else {
+                REQUIRE((std::is_same<T, Interface>::value));
+                ++others;
+            }
+        });
+        REQUIRE(ids == impl1_ids);
+        REQUIRE(others == impl2_count);
+    }
+    SECTION("copies keep the buckets")
+    {
+        bucketed_vector copy(v);
+        REQUIRE(copy.count<Impl1>() == impl1_ids.size());
+        v.clear();
+        REQUIRE(v.empty());
+        REQUIRE(copy.size() == 64);
+        v.swap(copy);
+        REQUIRE(v.size() == 64);
+    }
+    SECTION("the bucket found last is not mixed up after a swap or a move")
+    {
+        bucketed_vector other;
+        other.push_back(Impl3());
+        v.swap(other);
+        v.emplace_back<Impl1>(1);
+        REQUIRE(v.count<Impl1>() == 1);
+        REQUIRE(v.count<Impl3>() == 1);
+        bucketed_vector moved(std::move(other));
+        other.push_back(Impl2());
+        REQUIRE(other.buckets() == 1);
+        REQUIRE(other.count<Impl2>() == 1);
+        moved.push_back(Impl3());
+        REQUIRE(moved.count<Impl3>() == 1);
+        REQUIRE(moved.count<Impl1>() == impl1_ids.size());
+    }
+    SECTION("reserve prepares the bucket of the type")
+    {
+        v.reserve<Impl3>(16);
+        REQUIRE(v.buckets() == 3);
+        REQUIRE(v.count<Impl3>() == 0);
+    }
+}
+
+TYPE_P_TEST_CASE("bucketed vector keys the buckets by the type id of the cloning policy",
+    "[bucketed_vector]", Policy, poly::delegate_cloning_policy<Interface>,
+    poly::descriptor_cloning_policy<Interface>, poly::virtual_cloning_policy)
+{
+    using bucketed_vector = poly::bucketed_vector<Interface, std::allocator<Interface>, Policy>;
+    using Impl3           = Impl2T<poly::delegate_cloning_policy<Interface>>;
+
+    bucketed_vector v;
+    for (auto i = 0; i < 12; ++i) {
+        switch (i % 3) {
+        case 0:
+            v.template emplace_back<Impl1>(i);
+            break;
+        case 1:
+            v.push_back(Impl2());
+            break;
+        default:
+            v.push_back(Impl3());
+        }
+    }
+    REQUIRE(v.buckets() == 3);
+    REQUIRE(v.template count<Impl1>() == 4);
+    REQUIRE(v.template count<Impl2>() == 4);
+    REQUIRE(v.template count<Impl3>() == 4);
+
+    size_t impl3_count = 0;
+    v.template for_each_as<Impl3>([&](auto& obj) {
+        using T = std::decay_t<decltype(obj)>;
+        impl3_count += std::is_same<T, Impl3>::value ? 1 : 0;
+        REQUIRE((std::is_same<T, Impl3>::value || dynamic_cast<Impl3*>(&obj) == nullptr));
+    });
+    REQUIRE(impl3_count == 4);
+}
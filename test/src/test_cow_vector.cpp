@@ -0,0 +1,238 @@
+#include "catch_ext.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+#include "test_poly_vector.h"
+#include <poly/cow_vector.h>
+
+namespace {
+using cow_vector = poly::cow_vector<Interface>;
+
+std::vector<size_t> ids_of(const cow_vector& vec)
+{
+    std::vector<size_t> res;
+    for (const auto& elem : vec) {
+        res.push_back(elem.getId());
+    }
+    return res;
+}
+} // namespace
+
+TEST_CASE("cow vector copies share the objects until modified", "[cow_vector]")
+{
+    cow_vector          v;
+    std::vector<size_t> ids;
+    REQUIRE(v.empty());
+    REQUIRE(v.use_count() == 0);
+    for (auto i = 0; i < 16; ++i) {
+        if (i % 4 == 1) {
+            v.push_back(Impl2());
+        } else {
+            v.emplace_back<Impl1>(i);
+        }
+        ids.push_back(v.back().getId());
+    }
+    REQUIRE(v.unique());
+    const auto first = &v[0];
+    REQUIRE(&v[0] == first);
+
+    cow_vector        copy(v);
+    const cow_vector& ccopy = copy;
+    REQUIRE(v.use_count() == 2);
+    REQUIRE_FALSE(v.unique());
+    REQUIRE(&ccopy[0] == first);
+    REQUIRE(&ccopy.at(15) == &v.get()[15]);
+    REQUIRE(ids == ids_of(copy));
+    REQUIRE(v.use_count() == 2);
+
+    SECTION("appending detaches the modified copy only")
+    {
+        copy.push_back(Impl1(1.0));
+        REQUIRE(v.unique());
+        REQUIRE(copy.unique());
+        REQUIRE(copy.size() == 17);
+        REQUIRE(v.size() == 16);
+        REQUIRE(&ccopy[0] != first);
+        REQUIRE(&v.get()[0] == first);
+        REQUIRE(dynamic_cast<const Impl2*>(&ccopy[1]) != nullptr);
+    }
+    SECTION("const iteration never detaches")
+    {
+        std::vector<size_t> visited;
+        copy.for_each([&](const Interface& obj) { visited.push_back(obj.getId()); });
+        for (auto it = copy.cbegin(); it != copy.cend(); ++it) {
+            REQUIRE(it->getId() == visited[static_cast<size_t>(it - copy.cbegin())]);
+        }
+        REQUIRE(visited == ids);
+        REQUIRE(v.use_count() == 2);
+    }
+    SECTION("non-const element access detaches")
+    {
+        copy[3].function();
+        REQUIRE(v.unique());
+        REQUIRE(&ccopy[3] != &v.get()[3]);
+        REQUIRE(ids == ids_of(copy));
+    }
+    SECTION("erase accepts iterators from before detaching")
+    {
+        const auto it = ccopy.begin() + 2;
+        REQUIRE(copy.erase(it)->getId() == ids[3]);
+        REQUIRE(copy.erase(ccopy.begin(), ccopy.begin() + 2) == copy.begin());
+        REQUIRE(ids == ids_of(v));
+        ids.erase(ids.begin(), ids.begin() + 3);
+        REQUIRE(ids == ids_of(copy));
+    }
+    SECTION("clearing a shared copy releases it without cloning")
+    {
+        copy.clear();
+        REQUIRE(copy.empty());
+        REQUIRE(copy.use_count() == 0);
+        REQUIRE(v.unique());
+        v.clear();
+        REQUIRE(v.unique());
+        REQUIRE(v.capacity() >= 16);
+    }
+    SECTION("assignment and moves share without cloning")
+    {
+        cow_vector other;
+        other.push_back(Impl1(1.0));
+        other = copy;
+        REQUIRE(v.use_count() == 3);
+        cow_vector moved(std::move(other));
+        REQUIRE(other.empty());
+        REQUIRE(v.use_count() == 3);
+        REQUIRE(&moved.get()[0] == first);
+        swap(moved, other);
+        REQUIRE(moved.empty());
+        REQUIRE(&other.get()[0] == first);
+    }
+    SECTION("failing detach leaves the objects shared")
+    {
+        copy.clear();
+        v[5].set_throw_on_copy_construction(true);
+        REQUIRE(&v[0] == first);
+        cow_vector snapshot(v);
+        REQUIRE_THROWS(snapshot.push_back(Impl1(1.0)));
+        REQUIRE(snapshot.use_count() == 2);
+        REQUIRE(snapshot.size() == 16);
+    }
+}
+
+TEST_CASE("cow vector adopts a vector without cloning", "[cow_vector]")
+{
+    cow_vector::vector_type v;
+    v.push_back(Impl1(1.0));
+    v.push_back(Impl2());
+    const auto first = &v[0];
+
+    cow_vector cow(std::move(v));
+    REQUIRE(cow.size() == 2);
+    REQUIRE(&cow.get()[0] == first);
+    REQUIRE(&cow.front() == first);
+    REQUIRE_THROWS_AS(cow.at(2), std::out_of_range);
+}
+
+namespace {
+/// allocator without a default constructor that only compares equal to the allocators of the
+/// same tag and propagates on copy assignment and swap if Propagate is set
+template <class T, class Propagate = std::false_type> struct tagged_allocator {
+    using value_type                             = T;
+    using propagate_on_container_copy_assignment = Propagate;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap            = Propagate;
+    using is_always_equal                        = std::false_type;
+    template <class U> struct rebind {
+        using other = tagged_allocator<U, Propagate>;
+    };
+
+    explicit tagged_allocator(int t) noexcept
+        : tag { t }
+    {
+    }
+    template <class U>
+    tagged_allocator(const tagged_allocator<U, Propagate>& a) noexcept
+        : tag { a.tag }
+    {
+    }
+
+    T*   allocate(size_t n) { return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, size_t n) noexcept { std::allocator<T>().deallocate(p, n); }
+    template <class U> bool operator==(const tagged_allocator<U, Propagate>& rhs) const noexcept
+    {
+        return tag == rhs.tag;
+    }
+    template <class U> bool operator!=(const tagged_allocator<U, Propagate>& rhs) const noexcept
+    {
+        return tag != rhs.tag;
+    }
+
+    int tag;
+};
+} // namespace
+
+TEST_CASE("cow vector keeps its allocator", "[cow_vector]")
+{
+    using alloc  = tagged_allocator<Interface>;
+    using vector = poly::cow_vector<Interface, alloc>;
+
+    const vector empty(alloc(1));
+    REQUIRE(empty.begin() == empty.end());
+    REQUIRE(empty.cbegin() == empty.cend());
+    REQUIRE(empty.use_count() == 0);
+    REQUIRE_THROWS_AS(empty.at(0), std::out_of_range);
+    REQUIRE(empty.get().empty());
+    REQUIRE(empty.get().get_allocator() == alloc(1));
+
+    vector v(alloc(1));
+    v.emplace_back<Impl1>(1.0);
+    v.push_back(Impl2());
+    const auto first = &v.get()[0];
+    const auto id    = v.get()[1].getId();
+    vector     w(alloc(2));
+    w.push_back(Impl1(2.0));
+
+    SECTION("copy assignment shares the objects without the allocator")
+    {
+        w = v;
+        REQUIRE(w.get_allocator() == alloc(2));
+        REQUIRE(v.use_count() == 2);
+        REQUIRE(&w.get()[0] == first);
+        w.push_back(Impl1(3.0));
+        REQUIRE(w.get().get_allocator() == alloc(2));
+        REQUIRE(w.get()[1].getId() == id);
+        REQUIRE(v.unique());
+    }
+    SECTION("a moved vector is cloned with the allocator of the container on modification")
+    {
+        w = std::move(v);
+        REQUIRE(w.get_allocator() == alloc(2));
+        REQUIRE(w.unique());
+        REQUIRE(&w.get()[0] == first);
+        w.pop_back();
+        REQUIRE(w.get().get_allocator() == alloc(2));
+        REQUIRE(w.size() == 1);
+        REQUIRE(&w.get()[0] != first);
+    }
+    SECTION("swap keeps the allocators")
+    {
+        swap(v, w);
+        REQUIRE(v.get_allocator() == alloc(1));
+        REQUIRE(w.get_allocator() == alloc(2));
+        REQUIRE(&w.get()[0] == first);
+    }
+    SECTION("propagating allocators follow the objects")
+    {
+        using palloc  = tagged_allocator<Interface, std::true_type>;
+        using pvector = poly::cow_vector<Interface, palloc>;
+        pvector p(palloc(1));
+        p.push_back(Impl1(1.0));
+        pvector q(palloc(2));
+        q = p;
+        REQUIRE(q.get_allocator() == palloc(1));
+        pvector r(palloc(3));
+        swap(q, r);
+        REQUIRE(q.get_allocator() == palloc(3));
+        REQUIRE(r.get_allocator() == palloc(1));
+        REQUIRE(r.use_count() == 2);
+    }
+}
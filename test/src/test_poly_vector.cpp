@@ -3,6 +3,8 @@
 #include <catch2/catch.hpp>
 #include <cstring>
 #include <iostream>
+#include <map>
+#include <random>
 #include <vector>
 
 #include "test_poly_vector.h"
@@ -593,7 +595,8 @@ TYPE_P_TEST_CASE("basic operations when using custom allocator", "[poly_vector_b
 }
 
 TYPE_P_TEST_CASE("poly vector modifiers test", "[vector]", CloningPolicy,
-    poly::virtual_cloning_policy, poly::delegate_cloning_policy<Interface>)
+    poly::virtual_cloning_policy, poly::delegate_cloning_policy<Interface>,
+    poly::descriptor_cloning_policy<Interface>)
 {
     using vector = poly::vector<Interface, std::allocator<Interface>, CloningPolicy>;
 
@@ -726,7 +729,7 @@ TYPE_P_TEST_CASE("poly vector modifiers test", "[vector]", CloningPolicy,
         while (v.capacity() - v.size() > 0) {
             v.push_back(Impl1 {});
         }
-        if (!std::is_same<CloningPolicy, poly::delegate_cloning_policy<Interface>> {}) {
+        if (!vector::interface_type_noexcept_movable::value) {
             std::vector<uint8_t> ref_storage(
                 static_cast<uint8_t*>(v.data().first), static_cast<uint8_t*>(v.data().second));
             auto data = v.data();
@@ -757,7 +760,7 @@ TYPE_P_TEST_CASE("poly vector modifiers test", "[vector]", CloningPolicy,
         auto start = v.begin() + 3;
         auto end   = start + 1;
 
-        if (!std::is_same<CloningPolicy, poly::delegate_cloning_policy<Interface>> {}) {
+        if (!vector::interface_type_noexcept_movable::value) {
             v.at(5).set_throw_on_copy_construction(true);
             auto old_sizes = v.sizes();
             REQUIRE_THROWS_AS(v.erase(start, end), std::exception);
@@ -795,3 +798,1770 @@ TYPE_P_TEST_CASE("poly vector modifiers test", "[vector]", CloningPolicy,
         REQUIRE(old_size + 1 == v.size());
     }
 }
+
+TYPE_P_TEST_CASE("visit passes the elements of the listed types as their concrete type",
+    "[vector]", CloningPolicy, poly::virtual_cloning_policy,
+    poly::delegate_cloning_policy<Interface>, poly::descriptor_cloning_policy<Interface>)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>, CloningPolicy>;
+    using Impl2  = Impl2T<CloningPolicy>;
+
+    vector              v;
+    std::vector<size_t> impl1_ids;
+    for (auto i = 0; i < 12; ++i) {
+        if (i % 3) {
+            v.push_back(Impl1(i));
+            impl1_ids.push_back(v.back().getId());
+        } else {
+            v.push_back(Impl2());
+        }
+    }
+
+    std::vector<size_t> ids;
+    size_t              impl2s = 0;
+    size_t              others = 0;
+    v.template visit<Impl1, Impl2>([&](auto& obj) {
+        using T = std::decay_t<decltype(obj)>;
+        if (std::is_same<T, Impl1>::value) {
+            ids.push_back(obj.getId());
+        } else if (std::is_same<T, Impl2>::value) {
+            ++impl2s;
+        } else {
+            ++others;
+        }
+    });
+    REQUIRE(ids == impl1_ids);
+    REQUIRE(impl2s == 4);
+    REQUIRE(others == 0);
+
+    const auto& cv = v;
+    ids.clear();
+    cv.template for_each_as<Impl1>([&](auto& obj) {
+        using T = std::remove_reference_t<decltype(obj)>;
+        static_assert(std::is_const<T>::value, "const vector passes const objects");
+        if (std::is_same<T, const Impl1>::value) {
+            ids.push_back(obj.getId());
+        } else {
+            ++others;
+        }
+    });
+    REQUIRE(ids == impl1_ids);
+    REQUIRE(others == 4);
+}
+
+TEST_CASE("compact index entries are smaller than pointer based ones", "[poly_vector_basic_tests]")
+{
+    using compact_vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::virtual_cloning_policy, poly::vector_layout<poly::compact_index>>;
+    using compact_delegate_vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::delegate_cloning_policy<Interface>, poly::vector_layout<poly::compact_index>>;
+
+    REQUIRE(8 == sizeof(compact_vector::elem_ptr));
+    REQUIRE(16 == sizeof(compact_delegate_vector::elem_ptr));
+    REQUIRE(sizeof(compact_delegate_vector::elem_ptr) < sizeof(poly::vector<Interface>::elem_ptr));
+    REQUIRE(std::is_trivially_copyable<compact_delegate_vector::elem_ptr>::value);
+}
+
+TEST_CASE("variant cloning policy stores a 1 byte type index", "[poly_vector_basic_tests]")
+{
+    using policy         = poly::variant_cloning_policy<Interface, Impl1, Impl2>;
+    using variant_vector = poly::vector<Interface, std::allocator<Interface>, policy>;
+    using compact_vector = poly::vector<Interface, std::allocator<Interface>, policy,
+        poly::vector_layout<poly::compact_index>>;
+    using compact_descriptor_vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::descriptor_cloning_policy<Interface>, poly::vector_layout<poly::compact_index>>;
+
+    static_assert(poly::vector_impl::is_cloning_policy<policy, Interface,
+                      std::allocator<Interface>>::value,
+        "variant cloning policy is a cloning policy");
+    REQUIRE(sizeof(policy) == 1);
+    REQUIRE(policy::type_id_of<Impl1>() == 1);
+    REQUIRE(policy::type_id_of<Impl2>() == 2);
+    REQUIRE(policy::type_id_of<Impl2T<policy>>() == 0);
+    REQUIRE(sizeof(compact_vector::elem_ptr) < sizeof(compact_descriptor_vector::elem_ptr));
+
+    variant_vector v;
+    v.push_back(Impl1(1.0));
+    v.push_back(Impl2());
+    v.emplace_back<Impl1>(2.0);
+    REQUIRE(v.max_align() == alignof(Impl2));
+    REQUIRE(dynamic_cast<Impl2*>(&v[1]) != nullptr);
+
+    variant_vector copy(v);
+    REQUIRE(copy.size() == 3);
+    REQUIRE(dynamic_cast<Impl2*>(&copy[1]) != nullptr);
+    copy.erase(copy.begin());
+    REQUIRE(dynamic_cast<Impl2*>(&copy[0]) != nullptr);
+
+    size_t impl1s = 0;
+    v.visit<Impl1>([&](auto& obj) {
+        if (std::is_same<std::decay_t<decltype(obj)>, Impl1>::value) {
+            ++impl1s;
+        }
+    });
+    REQUIRE(impl1s == 2);
+
+    compact_vector cv;
+    cv.push_back(Impl2());
+    cv.push_back(Impl1(3.0));
+    cv.shrink_to_fit();
+    REQUIRE(dynamic_cast<Impl1*>(&cv[1]) != nullptr);
+}
+
+TEST_CASE("descriptor cloning policy shares one descriptor per type", "[poly_vector_basic_tests]")
+{
+    using policy            = poly::descriptor_cloning_policy<Interface>;
+    using descriptor_vector = poly::vector<Interface, std::allocator<Interface>, policy>;
+    using Impl2             = Impl2T<policy>;
+
+    REQUIRE(sizeof(descriptor_vector::elem_ptr) == 3 * sizeof(void*));
+    REQUIRE(sizeof(descriptor_vector::elem_ptr) < sizeof(poly::vector<Interface>::elem_ptr));
+
+    const policy p1 { poly::type_tag<Impl1> {} };
+    const policy p2 { poly::type_tag<Impl2> {} };
+    REQUIRE(p1.type_id() == policy { poly::type_tag<Impl1> {} }.type_id());
+    REQUIRE(p1.type_id() != p2.type_id());
+    REQUIRE(p1.descriptor()->size == sizeof(Impl1));
+    REQUIRE(p2.descriptor()->align == alignof(Impl2));
+
+    descriptor_vector v;
+    v.push_back(Impl1 {});
+    v.push_back(Impl2 {});
+    v.push_back(Impl1 {});
+    v.reserve(16, 256, alignof(Impl2));
+    descriptor_vector v2 { v };
+    REQUIRE(v2.size() == 3);
+    REQUIRE(v2[0] == v[0]);
+    REQUIRE(v2[1] == v[1]);
+    REQUIRE(v2[2] == v[2]);
+    REQUIRE(is_aligned_properly(dynamic_cast<Impl2&>(v2[1])));
+    v2.erase(v2.begin());
+    REQUIRE(v2[0] == v[1]);
+    REQUIRE(v2[1] == v[2]);
+}
+
+using natural_pointer_layout = poly::vector_layout<poly::pointer_index, poly::natural_packing>;
+using natural_compact_layout = poly::vector_layout<poly::compact_index, poly::natural_packing>;
+using split_pointer_layout
+    = poly::vector_layout<poly::pointer_index, poly::max_align_packing, poly::split_allocation>;
+using split_compact_layout
+    = poly::vector_layout<poly::compact_index, poly::natural_packing, poly::split_allocation>;
+using tracked_pointer_layout = poly::vector_layout<poly::pointer_index, poly::max_align_packing,
+    poly::single_allocation, poly::full_tracking>;
+using tracked_compact_layout = poly::vector_layout<poly::compact_index, poly::natural_packing,
+    poly::single_allocation, poly::full_tracking>;
+using tracked_split_layout = poly::vector_layout<poly::pointer_index, poly::natural_packing,
+    poly::split_allocation, poly::full_tracking>;
+
+TEST_CASE("the default tracking keeps the container small", "[poly_vector_basic_tests]")
+{
+    using tracked = poly::vector<Interface, std::allocator<Interface>,
+        poly::delegate_cloning_policy<Interface>, tracked_pointer_layout>;
+    // allocator, index and storage pointers, largest alignment, payload, count and largest
+    // alignment of the objects, the address order flag sharing its word with the empty members
+    REQUIRE(sizeof(poly::vector<Interface>) == 10 * sizeof(void*));
+    REQUIRE(sizeof(tracked) > sizeof(poly::vector<Interface>));
+}
+
+TYPE_P_TEST_CASE("poly vector layouts", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, poly::vector_layout<poly::compact_index>,
+    natural_pointer_layout, natural_compact_layout, split_pointer_layout, split_compact_layout,
+    tracked_pointer_layout, tracked_compact_layout, tracked_split_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::delegate_cloning_policy<Interface>, Layout>;
+
+    vector              v;
+    std::vector<size_t> ids;
+    for (auto i = 0; i < 16; ++i) {
+        if (i % 3) {
+            v.push_back(Impl1(i));
+        } else {
+            v.push_back(Impl2());
+        }
+        ids.push_back(v.back().getId());
+    }
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+
+    SECTION("elements are accessible after reallocations")
+    {
+        REQUIRE(ids == ids_of(v));
+        REQUIRE(is_aligned_properly(dynamic_cast<Impl2&>(v[0])));
+        REQUIRE(is_aligned_properly(dynamic_cast<Impl1&>(v[1])));
+    }
+    SECTION("reserve keeps the elements")
+    {
+        v.reserve(v.capacity() * 4, 256);
+        REQUIRE(ids == ids_of(v));
+    }
+    SECTION("copy construction clones the elements")
+    {
+        vector v2(v);
+        REQUIRE(ids == ids_of(v2));
+        REQUIRE(std::addressof(v2[0]) != std::addressof(v[0]));
+    }
+    SECTION("copy assignment clones the elements")
+    {
+        vector v2;
+        v2.push_back(Impl1());
+        v2 = v;
+        REQUIRE(ids == ids_of(v2));
+    }
+    SECTION("erase from the middle keeps the order")
+    {
+        v.erase(v.begin() + 2, v.begin() + 5);
+        ids.erase(ids.begin() + 2, ids.begin() + 5);
+        REQUIRE(ids == ids_of(v));
+    }
+    SECTION("insert into the middle keeps the order")
+    {
+        Impl1 obj;
+        auto  it = v.insert(v.begin() + 7, obj);
+        ids.insert(ids.begin() + 7, obj.getId());
+        REQUIRE(it->getId() == obj.getId());
+        REQUIRE(ids == ids_of(v));
+    }
+}
+
+TEST_CASE("natural packing places every object at its own alignment", "[poly_vector_basic_tests]")
+{
+    using natural_vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::delegate_cloning_policy<Interface>, natural_pointer_layout>;
+    using padded_vector = poly::vector<Interface>;
+
+    natural_vector nv;
+    padded_vector  pv;
+    for (auto i = 0; i < 32; ++i) {
+        if (i % 8 == 3) {
+            nv.push_back(Impl2());
+            pv.push_back(Impl2());
+        } else {
+            nv.push_back(Impl1(i));
+            pv.push_back(Impl1(i));
+        }
+    }
+    REQUIRE(nv.max_align() == alignof(Impl2));
+    REQUIRE(nv.sizes().second < pv.sizes().second);
+
+    const auto check_alignment = [](natural_vector& v) {
+        for (auto i = 0U; i < v.size(); ++i) {
+            if (auto impl2 = dynamic_cast<Impl2*>(&v[i])) {
+                REQUIRE(is_aligned_properly(*impl2));
+            } else {
+                REQUIRE(is_aligned_properly(dynamic_cast<Impl1&>(v[i])));
+            }
+        }
+    };
+    check_alignment(nv);
+
+    SECTION("compaction after erase keeps the alignment")
+    {
+        nv.erase(nv.begin() + 1);
+        nv.erase(nv.begin() + 5, nv.begin() + 7);
+        REQUIRE(nv.size() == 29);
+        check_alignment(nv);
+    }
+    SECTION("insertion keeps the alignment")
+    {
+        nv.insert(nv.begin() + 1, Impl2());
+        nv.insert(nv.begin() + 1, Impl1());
+        REQUIRE(nv.size() == 34);
+        check_alignment(nv);
+    }
+}
+
+class RelocatableImpl : public Interface {
+public:
+    explicit RelocatableImpl(int v = 0)
+        : value { v }
+    {
+    }
+    RelocatableImpl(const RelocatableImpl&) = default;
+    RelocatableImpl(RelocatableImpl&& o) noexcept
+        : Interface(std::move(o))
+        , value { o.value }
+    {
+        ++moves;
+    }
+    void       function() override { ++value; }
+    Interface* clone(std::allocator<Interface> /*unused*/, void* dest) override
+    {
+        return new (dest) RelocatableImpl(*this);
+    }
+    Interface* move(std::allocator<Interface> /*unused*/, void* dest) override
+    {
+        return new (dest) RelocatableImpl(std::move(*this));
+    }
+
+    static size_t moves;
+
+private:
+    int value;
+};
+
+size_t RelocatableImpl::moves = 0;
+
+namespace poly {
+template <> struct is_trivially_relocatable<RelocatableImpl> : std::true_type {
+};
+} // namespace poly
+
+TYPE_P_TEST_CASE("trivially relocatable objects are relocated without moving them", "[vector]",
+    Layout, poly::vector_layout<poly::pointer_index>, natural_compact_layout)
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector = poly::vector<Interface, std::allocator<Interface>, policy, Layout>;
+    using traits = typename vector::cloning_policy_traits;
+
+    REQUIRE(traits::trivially_relocatable(policy { poly::type_tag<RelocatableImpl> {} }));
+    REQUIRE_FALSE(traits::trivially_relocatable(policy { poly::type_tag<Impl1> {} }));
+
+    RelocatableImpl::moves = 0;
+    vector              v;
+    std::vector<size_t> ids;
+    for (auto i = 0; i < 64; ++i) {
+        if (i % 16 == 15) {
+            v.push_back(Impl1(i));
+        } else {
+            v.template emplace_back<RelocatableImpl>(i);
+        }
+        ids.push_back(v.back().getId());
+    }
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+    REQUIRE(ids == ids_of(v));
+
+    v.reserve(v.capacity() * 2, 128);
+    REQUIRE(ids == ids_of(v));
+
+    v.erase(v.begin() + 1, v.begin() + 3);
+    ids.erase(ids.begin() + 1, ids.begin() + 3);
+    REQUIRE(ids == ids_of(v));
+    REQUIRE(RelocatableImpl::moves == 0);
+
+    v.erase(v.begin() + 10);
+    ids.erase(ids.begin() + 10);
+    REQUIRE(ids == ids_of(v));
+    REQUIRE(RelocatableImpl::moves == 0);
+}
+
+struct relocating_policy : poly::virtual_cloning_policy {
+    using trivially_relocatable = std::true_type;
+};
+
+TEST_CASE("cloning policies can declare their elements trivially relocatable",
+    "[poly_vector_basic_tests]")
+{
+    using traits = poly::vector_impl::cloning_policy_traits<relocating_policy, Interface,
+        std::allocator<Interface>>;
+    using default_traits = poly::vector_impl::cloning_policy_traits<poly::virtual_cloning_policy,
+        Interface, std::allocator<Interface>>;
+
+    REQUIRE(traits::trivially_relocatable(relocating_policy {}));
+    REQUIRE_FALSE(default_traits::trivially_relocatable(poly::virtual_cloning_policy {}));
+}
+
+class TrivialRecord : public Interface {
+public:
+    explicit TrivialRecord(int v = 0)
+        : value { v }
+    {
+    }
+    TrivialRecord(const TrivialRecord& o)
+        : Interface(o)
+        , value { o.value }
+    {
+        ++copies;
+    }
+    TrivialRecord(TrivialRecord&&) = default;
+    ~TrivialRecord() override { ++destructions; }
+    int        get() const noexcept { return value; }
+    void       function() override { ++value; }
+    Interface* clone(std::allocator<Interface> /*unused*/, void* dest) override
+    {
+        return new (dest) TrivialRecord(*this);
+    }
+    Interface* move(std::allocator<Interface> /*unused*/, void* dest) override
+    {
+        return new (dest) TrivialRecord(std::move(*this));
+    }
+
+    static size_t copies;
+    static size_t destructions;
+
+private:
+    int value;
+};
+
+size_t TrivialRecord::copies       = 0;
+size_t TrivialRecord::destructions = 0;
+
+namespace poly {
+template <> struct is_trivially_destructible<TrivialRecord> : std::true_type {
+};
+template <> struct is_trivially_copyable<TrivialRecord> : std::true_type {
+};
+} // namespace poly
+
+TEST_CASE("trivially destructible objects are not destroyed", "[poly_vector_basic_tests]")
+{
+    using descriptor_policy = poly::descriptor_cloning_policy<Interface>;
+    using variant_policy    = poly::variant_cloning_policy<Interface, TrivialRecord>;
+    using mixed_vector      = poly::vector<Interface, std::allocator<Interface>, descriptor_policy>;
+    using trivial_vector    = poly::vector<Interface, std::allocator<Interface>, variant_policy,
+        poly::vector_layout<poly::compact_index>>;
+
+    REQUIRE(mixed_vector::cloning_policy_traits::trivially_destructible(
+        descriptor_policy { poly::type_tag<TrivialRecord> {} }));
+    REQUIRE_FALSE(mixed_vector::cloning_policy_traits::trivially_destructible(
+        descriptor_policy { poly::type_tag<Impl1> {} }));
+    REQUIRE_FALSE(mixed_vector::trivially_destructible_elements::value);
+    REQUIRE(trivial_vector::trivially_destructible_elements::value);
+    REQUIRE_FALSE((poly::variant_cloning_policy<Interface, TrivialRecord,
+        Impl1>::trivially_destructible::value));
+    REQUIRE(std::is_trivially_destructible<mixed_vector::elem_ptr>::value);
+    REQUIRE(std::is_trivially_destructible<trivial_vector::elem_ptr>::value);
+    REQUIRE(std::is_trivially_destructible<poly::vector<Interface>::elem_ptr>::value);
+
+    TrivialRecord::destructions = 0;
+    SECTION("only the objects of other types are destroyed")
+    {
+        mixed_vector v;
+        for (auto i = 0; i < 32; ++i) {
+            if (i % 4 == 3) {
+                v.push_back(Impl1(i));
+            } else {
+                v.emplace_back<TrivialRecord>(i);
+            }
+        }
+        const auto destructions = TrivialRecord::destructions;
+        v.pop_back();
+        v.pop_back();
+        v.erase(v.begin(), v.begin() + 4);
+        REQUIRE(v.size() == 26);
+        v.clear();
+        REQUIRE(v.empty());
+        REQUIRE(TrivialRecord::destructions == destructions);
+    }
+    SECTION("the flags of the types tell when only trivially destructible objects are left")
+    {
+        mixed_vector v;
+        v.push_back(Impl1(1.0));
+        for (auto i = 0; i < 8; ++i) {
+            v.emplace_back<TrivialRecord>(i);
+        }
+        v.push_back(Impl1(2.0));
+        const auto destructions = TrivialRecord::destructions;
+        v.erase(v.begin());
+        v.pop_back();
+        const auto capacity = v.capacity();
+        v.clear();
+        REQUIRE(v.empty());
+        REQUIRE(v.capacity() == capacity);
+        v.emplace_back<TrivialRecord>(1);
+        v.push_back(Impl1(3.0));
+        REQUIRE(v.size() == 2);
+        REQUIRE(TrivialRecord::destructions == destructions);
+    }
+    SECTION("clearing a container of trivially destructible objects forgets them")
+    {
+        trivial_vector v;
+        for (auto i = 0; i < 32; ++i) {
+            v.emplace_back<TrivialRecord>(i);
+        }
+        const auto destructions = TrivialRecord::destructions;
+        const auto capacity     = v.capacity();
+        const auto first        = &v[0];
+        v.clear();
+        REQUIRE(v.empty());
+        REQUIRE(v.capacity() == capacity);
+        REQUIRE(&v.emplace_back<TrivialRecord>(1) == first);
+        v.emplace_back<TrivialRecord>(2);
+        v.erase(v.begin());
+        REQUIRE(v.size() == 1);
+        REQUIRE(TrivialRecord::destructions == destructions);
+    }
+}
+
+TYPE_P_TEST_CASE("trivially copyable objects are copied in bulk", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, natural_compact_layout)
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector = poly::vector<Interface, std::allocator<Interface>, policy, Layout>;
+
+    vector              v;
+    std::vector<size_t> ids;
+    for (auto i = 0; i < 64; ++i) {
+        if (i % 16 == 7) {
+            v.push_back(Impl1(i));
+        } else if (i % 16 == 11) {
+            v.push_back(Impl2());
+        } else {
+            v.template emplace_back<TrivialRecord>(i);
+        }
+        ids.push_back(v.back().getId());
+    }
+    const auto check_copy = [&](const vector& copy) {
+        REQUIRE(copy.size() == ids.size());
+        for (size_t i = 0; i < copy.size(); ++i) {
+            REQUIRE(copy[i].getId() == ids[i]);
+            if (i % 16 == 7) {
+                REQUIRE(dynamic_cast<const Impl1*>(&copy[i]) != nullptr);
+            } else if (i % 16 == 11) {
+                REQUIRE(dynamic_cast<const Impl2*>(&copy[i]) != nullptr);
+            } else {
+                REQUIRE(dynamic_cast<const TrivialRecord&>(copy[i]).get() == int(i));
+                REQUIRE(&copy[i] != &v[i]);
+            }
+        }
+    };
+
+    TrivialRecord::copies = 0;
+    SECTION("copy construction")
+    {
+        vector copy(v);
+        check_copy(copy);
+    }
+    SECTION("copy assignment")
+    {
+        vector copy;
+        copy.push_back(Impl1(1.0));
+        copy = v;
+        check_copy(copy);
+    }
+    SECTION("failing copy destroys the copied objects")
+    {
+        v[39].set_throw_on_copy_construction(true);
+        REQUIRE_THROWS(vector(v));
+    }
+    REQUIRE(TrivialRecord::copies == 0);
+}
+
+TYPE_P_TEST_CASE("remove_if removes the matching elements in a single pass", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, poly::vector_layout<poly::compact_index>,
+    natural_pointer_layout, natural_compact_layout, split_pointer_layout, split_compact_layout)
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector = poly::vector<Interface, std::allocator<Interface>, policy, Layout>;
+    using Impl2  = Impl2T<policy>;
+
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+
+    vector              v;
+    std::vector<size_t> ids;
+    for (auto i = 0; i < 96; ++i) {
+        switch (i % 5) {
+        case 0:
+            v.push_back(Impl1(i));
+            break;
+        case 1:
+        case 3:
+            v.template emplace_back<TrivialRecord>(i);
+            break;
+        case 2:
+            v.template emplace_back<RelocatableImpl>(i);
+            break;
+        default:
+            v.push_back(Impl2());
+        }
+        ids.push_back(v.back().getId());
+    }
+    const auto removed = [](const Interface& obj) { return obj.getId() % 3 == 1; };
+    const auto check   = [&]() {
+        REQUIRE(ids == ids_of(v));
+        for (const auto& obj : v) {
+            const auto align = dynamic_cast<const Impl2*>(&obj) ? alignof(Impl2) : alignof(Impl1);
+            REQUIRE(reinterpret_cast<uintptr_t>(&obj) % align == 0);
+        }
+        // every free hole lies below the end of the objects
+        const auto info = v.fragmentation();
+        REQUIRE(info.hole_bytes <= info.unused_bytes);
+    };
+
+    SECTION("removed objects release their storage")
+    {
+        const auto last  = reinterpret_cast<uintptr_t>(&v.back());
+        const auto count = size_t(std::count_if(v.begin(), v.end(), removed));
+        REQUIRE(count > 0);
+        REQUIRE(poly::erase_if(v, removed) == count);
+        ids.erase(std::remove_if(ids.begin(), ids.end(), [](size_t id) { return id % 3 == 1; }),
+            ids.end());
+        check();
+        REQUIRE(reinterpret_cast<uintptr_t>(&v.back()) < last);
+        REQUIRE(v.remove_if(removed) == 0);
+        v.push_back(Impl2());
+        ids.push_back(v.back().getId());
+        check();
+        REQUIRE(v.remove_if([](const Interface&) { return true; }) == ids.size());
+        REQUIRE(v.empty());
+    }
+    SECTION("free holes left by erase_unordered are kept below the objects")
+    {
+        for (auto i = 0; i < 8; ++i) {
+            const auto pos = static_cast<size_t>(7 * i + 3);
+            ids[pos]       = ids.back();
+            ids.pop_back();
+            v.erase_unordered(v.begin() + static_cast<std::ptrdiff_t>(pos));
+        }
+        check();
+        v.remove_if(removed);
+        ids.erase(std::remove_if(ids.begin(), ids.end(), [](size_t id) { return id % 3 == 1; }),
+            ids.end());
+        check();
+        for (auto i = 0; i < 16; ++i) {
+            v.push_back(Impl2());
+            ids.push_back(v.back().getId());
+        }
+        check();
+    }
+    SECTION("unordered layouts only drop the entries")
+    {
+        v.insert(v.begin() + 5, Impl1(1.0));
+        ids.insert(ids.begin() + 5, v[5].getId());
+        v.remove_if(removed);
+        ids.erase(std::remove_if(ids.begin(), ids.end(), [](size_t id) { return id % 3 == 1; }),
+            ids.end());
+        check();
+    }
+    SECTION("a throwing predicate leaves the rest of the elements in place")
+    {
+        size_t calls = 0;
+        REQUIRE_THROWS(v.remove_if([&](const Interface& obj) {
+            if (++calls == 50) {
+                throw std::runtime_error("predicate failed");
+            }
+            return removed(obj);
+        }));
+        ids.erase(std::remove_if(ids.begin(), ids.begin() + 49,
+                      [](size_t id) { return id % 3 == 1; }),
+            ids.begin() + 49);
+        check();
+        v.push_back(Impl1(1.0));
+        REQUIRE(v.size() == ids.size() + 1);
+    }
+}
+
+TYPE_P_TEST_CASE("erase_unordered moves the last element into the erased slot", "[vector]",
+    Layout, poly::vector_layout<poly::pointer_index>, poly::vector_layout<poly::compact_index>,
+    natural_pointer_layout, natural_compact_layout, split_pointer_layout, split_compact_layout)
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector = poly::vector<Interface, std::allocator<Interface>, policy, Layout>;
+    using Impl2  = Impl2T<policy>;
+
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+    const auto aligned = [](const vector& vec) {
+        return std::all_of(vec.begin(), vec.end(), [](const Interface& obj) {
+            const auto align = dynamic_cast<const Impl2*>(&obj) ? alignof(Impl2) : alignof(Impl1);
+            return reinterpret_cast<uintptr_t>(&obj) % align == 0;
+        });
+    };
+
+    vector v;
+    v.reserve(16, 128, alignof(Impl2));
+    for (auto i = 0; i < 8; ++i) {
+        v.template emplace_back<TrivialRecord>(i);
+    }
+
+    SECTION("an object fitting in the freed storage is relocated there")
+    {
+        const auto erased = &v[2];
+        const auto id     = v.back().getId();
+        REQUIRE(v.erase_unordered(v.begin() + 2)->getId() == id);
+        REQUIRE(&v[2] == erased);
+        REQUIRE(v.size() == 7);
+        const auto it = v.erase_unordered(v.end() - 1);
+        REQUIRE(it == v.end());
+        REQUIRE(v.size() == 6);
+    }
+    SECTION("a larger object stays where it is")
+    {
+        v.push_back(Impl2());
+        const auto last = &v.back();
+        const auto id   = v.back().getId();
+        REQUIRE(v.erase_unordered(v.begin())->getId() == id);
+        REQUIRE(&v[0] == last);
+        REQUIRE(aligned(v));
+        v.template emplace_back<TrivialRecord>(1);
+        REQUIRE(v.size() == 9);
+    }
+    SECTION("random modifications keep the swap and pop order")
+    {
+        std::vector<size_t> ids = ids_of(v);
+        std::srand(7);
+        for (auto i = 0; i < 256; ++i) {
+            const auto pos = ids.empty() ? 0 : static_cast<size_t>(std::rand()) % ids.size();
+            switch (std::rand() % 5) {
+            case 0:
+                v.push_back(Impl1(i));
+                ids.push_back(v.back().getId());
+                break;
+            case 1:
+                v.push_back(Impl2());
+                ids.push_back(v.back().getId());
+                break;
+            case 2:
+                v.template emplace_back<TrivialRecord>(i);
+                ids.push_back(v.back().getId());
+                break;
+            default:
+                if (!ids.empty()) {
+                    v.erase_unordered(v.begin() + pos);
+                    ids[pos] = ids.back();
+                    ids.pop_back();
+                }
+            }
+            REQUIRE(ids == ids_of(v));
+            REQUIRE(aligned(v));
+        }
+        vector copy(v);
+        REQUIRE(ids == ids_of(copy));
+    }
+}
+
+TYPE_P_TEST_CASE("new objects fill the storage freed by erase before growing", "[vector]",
+    Layout, tracked_pointer_layout, tracked_compact_layout, tracked_split_layout)
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector = poly::vector<Interface, std::allocator<Interface>, policy, Layout>;
+    using Impl2  = Impl2T<policy>;
+
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+    const auto aligned = [](const vector& vec) {
+        return std::all_of(vec.begin(), vec.end(), [](const Interface& obj) {
+            const auto align = dynamic_cast<const Impl2*>(&obj) ? alignof(Impl2) : alignof(Impl1);
+            return reinterpret_cast<uintptr_t>(&obj) % align == 0;
+        });
+    };
+
+    // the storage runs out before the index does
+    vector v;
+    v.reserve(64, sizeof(TrivialRecord) / 2, alignof(Impl1));
+    for (auto i = 0; i < 8; ++i) {
+        v.template emplace_back<TrivialRecord>(i);
+    }
+    v.push_back(Impl1(1.0));
+    REQUIRE(v.fragmentation().holes == 0);
+
+    SECTION("the storage of an erased object is reused")
+    {
+        const auto erased = &v[0];
+        v.erase_unordered(v.begin());
+        const auto info = v.fragmentation();
+        REQUIRE(info.holes == 1);
+        REQUIRE(info.hole_bytes >= sizeof(TrivialRecord));
+        REQUIRE(info.unused_bytes >= info.hole_bytes);
+        const auto storage = v.data().first;
+        auto       reused  = false;
+        while (!reused && v.data().first == storage) {
+            v.template emplace_back<TrivialRecord>(1);
+            reused = &v.back() == erased;
+        }
+        REQUIRE(reused);
+        REQUIRE(v.data().first == storage);
+        REQUIRE(v.fragmentation().holes == 0);
+        REQUIRE(aligned(v));
+        v.clear();
+        REQUIRE(v.fragmentation().unused_bytes == 0);
+    }
+    SECTION("random modifications keep the objects intact")
+    {
+        std::vector<size_t> ids = ids_of(v);
+        std::srand(11);
+        for (auto i = 0; i < 512; ++i) {
+            const auto pos = ids.empty() ? 0 : static_cast<size_t>(std::rand()) % ids.size();
+            switch (std::rand() % 8) {
+            case 0:
+            case 7:
+                v.push_back(Impl1(i));
+                ids.push_back(v.back().getId());
+                break;
+            case 1:
+                v.insert(v.begin() + pos, Impl2());
+                ids.insert(ids.begin() + pos, v[pos].getId());
+                break;
+            case 2:
+                v.template emplace_back<TrivialRecord>(i);
+                ids.push_back(v.back().getId());
+                break;
+            case 3:
+                if (!ids.empty()) {
+                    v.erase(v.begin() + pos);
+                    ids.erase(ids.begin() + pos);
+                }
+                break;
+            case 4:
+                v.remove_if([](const Interface& obj) { return obj.getId() % 5 == 0; });
+                ids.erase(
+                    std::remove_if(ids.begin(), ids.end(), [](size_t id) { return id % 5 == 0; }),
+                    ids.end());
+                break;
+            default:
+                if (!ids.empty()) {
+                    v.erase_unordered(v.begin() + pos);
+                    ids[pos] = ids.back();
+                    ids.pop_back();
+                }
+            }
+            REQUIRE(ids == ids_of(v));
+            REQUIRE(aligned(v));
+            REQUIRE(v.fragmentation().hole_bytes <= v.fragmentation().unused_bytes);
+        }
+        vector copy(v);
+        REQUIRE(ids == ids_of(copy));
+        REQUIRE(copy.fragmentation().holes == 0);
+    }
+}
+
+TEST_CASE("without free lists the storage freed by erase is reclaimed by moving the objects",
+    "[vector]")
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector
+        = poly::vector<Interface, std::allocator<Interface>, policy, natural_pointer_layout>;
+    using Impl2 = Impl2T<policy>;
+
+    vector v;
+    for (auto i = 0; i < 4; ++i) {
+        v.push_back(Impl1(i));
+    }
+    v.push_back(Impl2());
+    const auto last = &v.back();
+    v.erase_unordered(v.begin());
+    REQUIRE(&v[0] == last);
+    const auto info = v.fragmentation();
+    REQUIRE(info.holes == 0);
+    REQUIRE(info.hole_bytes == 0);
+    REQUIRE(info.unused_bytes > 0);
+    // the copy only leaves the alignment padding of the objects unused
+    vector copy(v);
+    REQUIRE(copy.fragmentation().unused_bytes < info.unused_bytes);
+    REQUIRE(copy.fragmentation().unused_bytes < alignof(Impl2));
+    REQUIRE(copy.size() == 4);
+}
+
+TYPE_P_TEST_CASE("defragment compacts the objects within the given budget", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, poly::vector_layout<poly::compact_index>,
+    natural_pointer_layout, natural_compact_layout, split_pointer_layout, split_compact_layout,
+    tracked_pointer_layout, tracked_compact_layout, tracked_split_layout)
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector = poly::vector<Interface, std::allocator<Interface>, policy, Layout>;
+    using Impl2  = Impl2T<policy>;
+
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+    const auto in_index_order = [](const vector& vec) {
+        for (size_t i = 1; i < vec.size(); ++i) {
+            if (reinterpret_cast<uintptr_t>(&vec[i - 1]) >= reinterpret_cast<uintptr_t>(&vec[i])) {
+                return false;
+            }
+        }
+        return true;
+    };
+    const auto defragment_all = [](vector& vec, size_t budget) {
+        auto calls = 0;
+        for (size_t moved = 1; moved != 0 && calls < 1000; ++calls) {
+            moved = vec.defragment(budget);
+            REQUIRE(moved <= budget);
+        }
+        return calls < 1000;
+    };
+
+    vector v;
+    v.reserve(64, 64, alignof(Impl1));
+    std::vector<size_t> ids;
+    for (auto i = 0; i < 32; ++i) {
+        if (i % 3 == 0) {
+            v.template emplace_back<TrivialRecord>(i);
+        } else {
+            v.template emplace_back<RelocatableImpl>(i);
+        }
+        ids.push_back(v.back().getId());
+    }
+    REQUIRE(v.defragment(1024) == 0);
+
+    SECTION("trivially relocatable objects are packed in index order")
+    {
+        for (auto i = 0; i < 8; ++i) {
+            v.insert(v.begin() + 3 * i, RelocatableImpl(i));
+            ids.insert(ids.begin() + 3 * i, v[3 * i].getId());
+        }
+        for (auto i = 0; i < 8; ++i) {
+            v.erase_unordered(v.begin() + 2 * i);
+            ids[2 * i] = ids.back();
+            ids.pop_back();
+        }
+        REQUIRE(ids == ids_of(v));
+        REQUIRE(v.fragmentation().unused_bytes > 0);
+        const auto storage = v.data().first;
+        REQUIRE(defragment_all(v, 3 * sizeof(RelocatableImpl)));
+        REQUIRE(ids == ids_of(v));
+        REQUIRE(in_index_order(v));
+        REQUIRE(v.data().first == storage);
+        REQUIRE(v.fragmentation().holes == 0);
+        REQUIRE(v.fragmentation().unused_bytes < v.size() * v.max_align());
+    }
+    SECTION("random modifications between the calls keep the objects intact")
+    {
+        std::srand(5);
+        for (auto i = 0; i < 256; ++i) {
+            const auto pos = ids.empty() ? 0 : static_cast<size_t>(std::rand()) % ids.size();
+            switch (std::rand() % 5) {
+            case 0:
+                v.insert(v.begin() + pos, Impl1(i));
+                ids.insert(ids.begin() + pos, v[pos].getId());
+                break;
+            case 1:
+                v.insert(v.begin() + pos, RelocatableImpl(i));
+                ids.insert(ids.begin() + pos, v[pos].getId());
+                break;
+            case 2:
+                v.push_back(Impl2());
+                ids.push_back(v.back().getId());
+                break;
+            case 3:
+                if (!ids.empty()) {
+                    v.erase_unordered(v.begin() + pos);
+                    ids[pos] = ids.back();
+                    ids.pop_back();
+                }
+                break;
+            default:
+                REQUIRE(v.defragment(256) <= 256);
+            }
+            REQUIRE(ids == ids_of(v));
+            REQUIRE(std::all_of(v.begin(), v.end(), [](const Interface& obj) {
+                return reinterpret_cast<uintptr_t>(&obj) % alignof(Interface) == 0;
+            }));
+        }
+        REQUIRE(defragment_all(v, 4096));
+        REQUIRE(ids == ids_of(v));
+        vector copy(v);
+        REQUIRE(ids == ids_of(copy));
+    }
+    SECTION("small budgets between unordered removals and appends keep the free holes intact")
+    {
+        std::mt19937 gen(11);
+        for (auto i = 0; i < 2048; ++i) {
+            const auto pos = ids.empty() ? 0 : gen() % ids.size();
+            switch (gen() % 6) {
+            case 0:
+                v.push_back(Impl1(i));
+                break;
+            case 1:
+                v.template emplace_back<RelocatableImpl>(i);
+                break;
+            case 2:
+                v.template emplace_back<TrivialRecord>(i);
+                break;
+            case 3:
+                if (!ids.empty()) {
+                    v.erase_unordered(v.begin() + pos);
+                    ids[pos] = ids.back();
+                    ids.pop_back();
+                }
+                continue;
+            default:
+                REQUIRE(v.defragment(gen() % 160) <= 160);
+                continue;
+            }
+            ids.push_back(v.back().getId());
+            if (ids.size() > 48) {
+                v.erase_unordered(v.begin());
+                ids.front() = ids.back();
+                ids.pop_back();
+            }
+        }
+        REQUIRE(ids == ids_of(v));
+        REQUIRE(defragment_all(v, 64));
+        REQUIRE(ids == ids_of(v));
+        REQUIRE(v.fragmentation().holes == 0);
+    }
+}
+
+TYPE_P_TEST_CASE("defragment moves the objects overlapping their destination through the free "
+                 "storage",
+    "[vector]", Layout, poly::vector_layout<poly::pointer_index>, natural_pointer_layout,
+    natural_compact_layout, split_pointer_layout, tracked_compact_layout)
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector = poly::vector<Interface, std::allocator<Interface>, policy, Layout>;
+    using Impl2  = Impl2T<policy>;
+
+    // neither type is trivially relocatable, the objects behind the hole are larger than it and
+    // the hole is larger than their alignment
+    vector v;
+    v.reserve(8, 4 * sizeof(Impl2), alignof(Impl2));
+    v.push_back(Impl1(1.0));
+    v.push_back(Impl1(2.0));
+    v.push_back(Impl1(3.0));
+    v.push_back(Impl2());
+    v.push_back(Impl2());
+    v.erase(v.begin() + 1, v.begin() + 3);
+    const auto ids = std::vector<size_t> { v[0].getId(), v[1].getId(), v[2].getId() };
+    REQUIRE(v.fragmentation().unused_bytes >= 2 * sizeof(Impl1));
+
+    const auto storage = v.data().first;
+    // moving an object twice takes twice its size from the budget
+    REQUIRE(v.defragment(sizeof(Impl2)) == 0);
+    REQUIRE(v.defragment(2 * sizeof(Impl2)) == 2 * sizeof(Impl2));
+    REQUIRE(v.defragment(2 * sizeof(Impl2)) == 2 * sizeof(Impl2));
+    REQUIRE(v.defragment(2 * sizeof(Impl2)) == 0);
+    REQUIRE(v.data().first == storage);
+    REQUIRE(ids == std::vector<size_t> { v[0].getId(), v[1].getId(), v[2].getId() });
+    // only the alignment of the objects separates them
+    const auto gap = [&v](size_t i) {
+        return static_cast<size_t>(reinterpret_cast<const char*>(&v[i])
+            - reinterpret_cast<const char*>(&v[i - 1]));
+    };
+    REQUIRE(gap(1) >= sizeof(Impl1));
+    REQUIRE(gap(1) < sizeof(Impl1) + alignof(Impl2));
+    REQUIRE(gap(2) == sizeof(Impl2));
+}
+
+TYPE_P_TEST_CASE("sort permutes the index and relayout moves the objects", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, natural_compact_layout, split_pointer_layout)
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector = poly::vector<Interface, std::allocator<Interface>, policy, Layout>;
+    using Impl2  = Impl2T<policy>;
+
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+    const auto in_index_order = [](const vector& vec) {
+        for (size_t i = 1; i < vec.size(); ++i) {
+            if (reinterpret_cast<uintptr_t>(&vec[i - 1]) >= reinterpret_cast<uintptr_t>(&vec[i])) {
+                return false;
+            }
+        }
+        return true;
+    };
+    const auto by_id = [](const Interface& lhs, const Interface& rhs) {
+        return lhs.getId() > rhs.getId();
+    };
+
+    vector                             v;
+    std::vector<size_t>                ids;
+    std::map<size_t, const Interface*> addresses;
+    for (auto i = 0; i < 48; ++i) {
+        switch (i % 3) {
+        case 0:
+            v.push_back(Impl1(i));
+            break;
+        case 1:
+            v.push_back(Impl2());
+            break;
+        default:
+            v.template emplace_back<RelocatableImpl>(i);
+        }
+        ids.push_back(v.back().getId());
+    }
+    for (const auto& elem : v) {
+        addresses[elem.getId()] = &elem;
+    }
+    REQUIRE(in_index_order(v));
+
+    v.sort(by_id);
+    std::sort(ids.begin(), ids.end(), std::greater<size_t>());
+    REQUIRE(ids == ids_of(v));
+    for (const auto& elem : v) {
+        REQUIRE(addresses[elem.getId()] == &elem);
+    }
+    REQUIRE_FALSE(in_index_order(v));
+
+    SECTION("relayout restores the address order")
+    {
+        v.relayout();
+        REQUIRE(ids == ids_of(v));
+        REQUIRE(in_index_order(v));
+        REQUIRE(std::all_of(v.begin(), v.end(), [](const Interface& obj) {
+            return dynamic_cast<const Impl2*>(&obj) == nullptr
+                || reinterpret_cast<uintptr_t>(&obj) % alignof(Impl2) == 0;
+        }));
+        v.push_back(Impl1(1.0));
+        REQUIRE(in_index_order(v));
+    }
+    SECTION("stable_sort keeps the order of equivalent elements")
+    {
+        const auto by_type = [](const Interface& lhs, const Interface& rhs) {
+            return typeid(lhs).before(typeid(rhs));
+        };
+        v.stable_sort(by_type);
+        const auto sorted = ids_of(v);
+        REQUIRE(std::is_permutation(sorted.begin(), sorted.end(), ids.begin()));
+        for (size_t i = 1; i < v.size(); ++i) {
+            REQUIRE_FALSE(by_type(v[i], v[i - 1]));
+            if (typeid(v[i - 1]) == typeid(v[i])) {
+                REQUIRE(v[i - 1].getId() > v[i].getId());
+            }
+        }
+        v.relayout();
+        REQUIRE(ids_of(v) == sorted);
+        REQUIRE(in_index_order(v));
+    }
+}
+
+TYPE_P_TEST_CASE("relayout packs the objects that cannot be relocated", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, natural_compact_layout, split_pointer_layout)
+{
+    using policy = poly::descriptor_cloning_policy<Interface>;
+    using vector = poly::vector<Interface, std::allocator<Interface>, policy, Layout>;
+    using Impl2  = Impl2T<policy>;
+
+    vector v;
+    v.push_back(Impl1(1.0));
+    v.push_back(Impl1(2.0));
+    v.push_back(Impl2());
+    v.push_back(Impl2());
+    SECTION("through the free storage") { v.reserve(8, 4 * sizeof(Impl2), alignof(Impl2)); }
+    SECTION("without free storage") { v.shrink_to_fit(); }
+    v.erase(v.begin() + 1);
+    const auto ids = std::vector<size_t> { v[0].getId(), v[1].getId(), v[2].getId() };
+    REQUIRE(v.fragmentation().unused_bytes >= sizeof(Impl1));
+
+    const auto gap = [&v](size_t i) {
+        return static_cast<size_t>(reinterpret_cast<const char*>(&v[i])
+            - reinterpret_cast<const char*>(&v[i - 1]));
+    };
+    v.relayout();
+    REQUIRE(ids == std::vector<size_t> { v[0].getId(), v[1].getId(), v[2].getId() });
+    // only the alignment of the objects separates them
+    REQUIRE(gap(1) >= sizeof(Impl1));
+    REQUIRE(gap(1) < sizeof(Impl1) + alignof(Impl2));
+    REQUIRE(gap(2) == sizeof(Impl2));
+}
+
+TYPE_P_TEST_CASE("group_by_type makes the elements of a type adjacent", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, natural_compact_layout, split_pointer_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::delegate_cloning_policy<Interface>, Layout>;
+
+    const auto in_index_order = [](const vector& vec) {
+        for (size_t i = 1; i < vec.size(); ++i) {
+            if (reinterpret_cast<uintptr_t>(&vec[i - 1]) >= reinterpret_cast<uintptr_t>(&vec[i])) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    vector                             v;
+    std::vector<size_t>                ids;
+    std::vector<const std::type_info*> types;
+    std::mt19937                       gen(7);
+    for (auto i = 0; i < 64; ++i) {
+        switch (gen() % 3) {
+        case 0:
+            v.template emplace_back<RelocatableImpl>(i);
+            break;
+        case 1:
+            v.push_back(Impl2());
+            break;
+        default:
+            v.push_back(Impl1(i));
+        }
+        ids.push_back(v.back().getId());
+        if (std::find(types.begin(), types.end(), &typeid(v.back())) == types.end()) {
+            types.push_back(&typeid(v.back()));
+        }
+    }
+    std::vector<size_t> expected;
+    for (const auto type : types) {
+        for (const auto& elem : v) {
+            if (typeid(elem) == *type) {
+                expected.push_back(elem.getId());
+            }
+        }
+    }
+    std::vector<const Interface*> addresses;
+    for (const auto& elem : v) {
+        addresses.push_back(&elem);
+    }
+
+    const auto check_grouped = [&] {
+        size_t type = 0;
+        for (size_t i = 0; i < v.size(); ++i) {
+            if (typeid(v[i]) != *types[type]) {
+                ++type;
+            }
+            REQUIRE(type < types.size());
+            REQUIRE(typeid(v[i]) == *types[type]);
+            REQUIRE(v[i].getId() == expected[i]);
+        }
+        REQUIRE(type + 1 == types.size());
+    };
+
+    SECTION("stable_partition_by_type permutes the index only")
+    {
+        v.stable_partition_by_type();
+        check_grouped();
+        for (const auto& elem : v) {
+            const auto pos = std::find(ids.begin(), ids.end(), elem.getId()) - ids.begin();
+            REQUIRE(addresses[pos] == &elem);
+        }
+    }
+    SECTION("group_by_type moves the objects into the new order")
+    {
+        v.group_by_type();
+        check_grouped();
+        REQUIRE(in_index_order(v));
+        v.group_by_type();
+        check_grouped();
+    }
+}
+
+TYPE_P_TEST_CASE("shrink_to_fit releases the unused storage", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, natural_compact_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::delegate_cloning_policy<Interface>, Layout>;
+
+    vector              v;
+    std::vector<size_t> ids;
+    v.reserve(64, 256, alignof(Impl2));
+    for (auto i = 0; i < 16; ++i) {
+        if (i % 4 == 1) {
+            v.push_back(Impl2());
+        } else {
+            v.push_back(Impl1(i));
+        }
+        ids.push_back(v.back().getId());
+    }
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+
+    SECTION("capacity is reduced to the size")
+    {
+        const auto old_storage = v.capacities().second;
+        v.shrink_to_fit();
+        REQUIRE(v.capacity() == v.size());
+        REQUIRE(v.capacities().second < old_storage);
+        REQUIRE(ids == ids_of(v));
+        REQUIRE(is_aligned_properly(dynamic_cast<Impl2&>(v[1])));
+        v.push_back(Impl1());
+        ids.push_back(v.back().getId());
+        REQUIRE(ids == ids_of(v));
+    }
+    SECTION("max alignment is recalculated from the remaining elements")
+    {
+        REQUIRE(v.max_align() == alignof(Impl2));
+        for (auto i = 13; i >= 1; i -= 4) {
+            v.erase(v.begin() + i);
+            ids.erase(ids.begin() + i);
+        }
+        const auto old_storage = v.capacities().second;
+        v.shrink_to_fit();
+        REQUIRE(v.max_align() == alignof(Impl1));
+        REQUIRE(v.capacities().second < old_storage);
+        REQUIRE(ids == ids_of(v));
+    }
+    SECTION("shrinking an empty vector releases all the memory")
+    {
+        v.clear();
+        v.shrink_to_fit();
+        REQUIRE(v.capacity() == 0);
+        REQUIRE(v.data().first == nullptr);
+        v.push_back(Impl1());
+        REQUIRE(v.size() == 1);
+    }
+    SECTION("shrinking twice does not reallocate")
+    {
+        v.shrink_to_fit();
+        const auto data = v.data();
+        v.shrink_to_fit();
+        REQUIRE(data == v.data());
+    }
+}
+
+TYPE_P_TEST_CASE("insert constructs the object in place when capacity allows", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, poly::vector_layout<poly::compact_index>,
+    natural_pointer_layout, natural_compact_layout, split_pointer_layout, split_compact_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::descriptor_cloning_policy<Interface>, Layout>;
+
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+    vector              v;
+    std::vector<size_t> ids;
+    v.reserve(16, 64);
+    for (auto i = 0; i < 4; ++i) {
+        v.push_back(Impl1(i));
+        ids.push_back(v.back().getId());
+    }
+    const auto data  = v.data();
+    const auto first = &v[0];
+    const auto last  = &v[3];
+
+    Impl1 obj;
+    ids.insert(ids.begin() + 1, obj.getId());
+    auto it = v.insert(v.begin() + 1, obj);
+    REQUIRE(it->getId() == obj.getId());
+    REQUIRE(ids == ids_of(v));
+    REQUIRE(data == v.data());
+    REQUIRE(first == &v[0]);
+    REQUIRE(last == &v[4]);
+
+    SECTION("an unordered vector can be copied") { REQUIRE(ids == ids_of(vector(v))); }
+    SECTION("an unordered vector can be erased from and grown")
+    {
+        v.erase(v.begin() + 2);
+        ids.erase(ids.begin() + 2);
+        v.pop_back();
+        ids.pop_back();
+        REQUIRE(ids == ids_of(v));
+        for (auto i = 0; i < 32; ++i) {
+            RelocatableImpl r(i);
+            ids.insert(ids.begin() + i % 3, r.getId());
+            v.insert(v.begin() + i % 3, r);
+        }
+        REQUIRE(ids == ids_of(v));
+        v.shrink_to_fit();
+        REQUIRE(ids == ids_of(v));
+    }
+}
+
+TYPE_P_TEST_CASE("copies have room for the objects laid out again in index order",
+    "[vector]", Layout, natural_pointer_layout, natural_compact_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::descriptor_cloning_policy<Interface>, Layout>;
+    using Impl2 = Impl2T<poly::descriptor_cloning_policy<Interface>>;
+
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+    // objects inserted in place may leave a layout that needs more padding once it is laid out
+    // again in index order, e.g. an over-aligned object behind a small one
+    for (unsigned seed = 0; seed < 2048; ++seed) {
+        std::mt19937        gen(seed);
+        vector              v;
+        std::vector<size_t> ids;
+        for (auto i = 0; i < 12; ++i) {
+            const auto pos = gen() % (ids.size() + 1);
+            switch (gen() % 5) {
+            case 0:
+                v.push_back(Impl2());
+                ids.push_back(v.back().getId());
+                break;
+            case 1:
+                v.push_back(TrivialRecord(i));
+                ids.push_back(v.back().getId());
+                break;
+            case 2: {
+                TrivialRecord obj(i);
+                ids.insert(ids.begin() + pos, obj.getId());
+                v.insert(v.begin() + pos, obj);
+                break;
+            }
+            case 3:
+                if (!ids.empty()) {
+                    v.erase(v.begin() + pos % ids.size());
+                    ids.erase(ids.begin() + pos % ids.size());
+                }
+                break;
+            default:
+                if (!ids.empty()) {
+                    v.pop_back();
+                    ids.pop_back();
+                }
+            }
+            const vector copy(v);
+            REQUIRE(ids == ids_of(copy));
+            vector assigned;
+            assigned.push_back(TrivialRecord(i));
+            assigned = v;
+            REQUIRE(ids == ids_of(assigned));
+        }
+    }
+}
+
+TYPE_P_TEST_CASE("range operations and the variadic constructor allocate once", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, poly::vector_layout<poly::compact_index>,
+    natural_pointer_layout, natural_compact_layout, split_pointer_layout, split_compact_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::descriptor_cloning_policy<Interface>, Layout>;
+    using Impl2 = Impl2T<poly::descriptor_cloning_policy<Interface>>;
+
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+    vector     src(Impl1(1), Impl2(), RelocatableImpl(2), Impl1(3));
+    const auto src_ids = ids_of(src);
+    REQUIRE(src.size() == 4);
+    REQUIRE(src.capacity() == 4);
+    REQUIRE(src.max_align() == alignof(Impl2));
+
+    vector v(Impl1(4), Impl1(5));
+    auto   ids = ids_of(v);
+
+    SECTION("insert sizes the reallocation for the whole range")
+    {
+        auto it = v.insert(v.begin() + 1, src.begin(), src.end());
+        ids.insert(ids.begin() + 1, src_ids.begin(), src_ids.end());
+        REQUIRE(it == v.begin() + 1);
+        REQUIRE(ids == ids_of(v));
+        REQUIRE(v.capacity() == 6);
+        REQUIRE(ids_of(src) == src_ids);
+    }
+    SECTION("append constructs in place when capacity allows")
+    {
+        v.reserve(16, 256, alignof(Impl2));
+        const auto data = v.data();
+        v.append(src.begin() + 1, src.end());
+        ids.insert(ids.end(), src_ids.begin() + 1, src_ids.end());
+        REQUIRE(ids == ids_of(v));
+        REQUIRE(data == v.data());
+    }
+    SECTION("assign replaces the content")
+    {
+        v.assign(src.begin(), src.begin() + 2);
+        REQUIRE(ids_of(v) == std::vector<size_t>(src_ids.begin(), src_ids.begin() + 2));
+        v.assign(src.end(), src.end());
+        REQUIRE(v.empty());
+    }
+    SECTION("failing to clone the range leaves the content unchanged")
+    {
+        src.back().set_throw_on_copy_construction(true);
+        REQUIRE_THROWS(v.insert(v.begin(), src.begin(), src.end()));
+        REQUIRE(ids == ids_of(v));
+        v.reserve(16, 256, alignof(Impl2));
+        REQUIRE_THROWS(v.insert(v.begin(), src.begin(), src.end()));
+        REQUIRE(ids == ids_of(v));
+    }
+}
+
+TEST_CASE("emplace_back_all constructs every object with at most one allocation", "[vector]")
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::descriptor_cloning_policy<Interface>>;
+    using Impl2  = Impl2T<poly::descriptor_cloning_policy<Interface>>;
+
+    auto v = poly::make_poly_vector<Interface>(Impl1(1.0), Impl1(2.0));
+    REQUIRE(v.size() == 2);
+    REQUIRE(v.capacity() == 2);
+
+    auto n = poly::make_poly_vector<Interface, std::allocator<Interface>,
+        poly::descriptor_cloning_policy<Interface>, natural_compact_layout>(Impl1(1.0), Impl2());
+    REQUIRE(n.size() == 2);
+    REQUIRE(n.capacity() == 2);
+    REQUIRE(n.max_align() == alignof(Impl2));
+    REQUIRE(dynamic_cast<Impl2*>(&n[1]) != nullptr);
+
+    vector w;
+    w.emplace_back_all<Impl1, Impl2, RelocatableImpl>(
+        std::make_tuple(1.0), std::make_tuple(), std::make_tuple(3));
+    REQUIRE(w.size() == 3);
+    REQUIRE(w.capacity() == 3);
+    REQUIRE(w.max_align() == alignof(Impl2));
+    REQUIRE(dynamic_cast<Impl2*>(&w[1]) != nullptr);
+
+    SECTION("objects are constructed in place when they fit")
+    {
+        w.reserve(8, 256, alignof(Impl2));
+        const auto data = w.data();
+        w.emplace_back_all<Impl1, Impl1>(std::make_tuple(4.0), std::make_tuple(5.0));
+        REQUIRE(w.size() == 5);
+        REQUIRE(data == w.data());
+    }
+    SECTION("either every object is added or none")
+    {
+        const Impl1 throwing(6.0, true);
+        REQUIRE_THROWS(w.emplace_back_all<Impl1, Impl1>(
+            std::make_tuple(7.0), std::forward_as_tuple(throwing)));
+        REQUIRE(w.size() == 3);
+        w.emplace_back_all<Impl1>(std::make_tuple(8.0));
+        REQUIRE(w.size() == 4);
+    }
+}
+
+TYPE_P_TEST_CASE("reserve_for fits the expected mix of objects", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, poly::vector_layout<poly::compact_index>,
+    natural_pointer_layout, natural_compact_layout, split_pointer_layout, split_compact_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::descriptor_cloning_policy<Interface>, Layout>;
+    using Impl2 = Impl2T<poly::descriptor_cloning_policy<Interface>>;
+
+    vector v;
+    v.push_back(Impl1());
+    v.template reserve_for<Impl1, Impl2, RelocatableImpl>(5, 3, 8);
+    REQUIRE(v.capacity() == 17);
+    REQUIRE(v.max_align() == alignof(Impl2));
+    auto data  = v.data();
+    auto kinds = std::vector<int> { 0, 0, 0, 0, 0, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2 };
+    std::shuffle(kinds.begin(), kinds.end(), std::mt19937 { 7 });
+    for (auto kind : kinds) {
+        switch (kind) {
+        case 0:
+            v.push_back(Impl1());
+            break;
+        case 1:
+            v.insert(v.begin(), Impl2());
+            break;
+        default:
+            v.template emplace_back<RelocatableImpl>(kind);
+            break;
+        }
+    }
+    REQUIRE(data == v.data());
+
+    v.reserve_for({ poly::count_of<Impl1>(1), poly::count_of<Impl2>(1) });
+    data = v.data();
+    v.push_back(Impl2());
+    v.push_back(Impl1());
+    REQUIRE(data == v.data());
+}
+
+TYPE_P_TEST_CASE("split allocation grows the index and the objects separately", "[vector]", Layout,
+    split_pointer_layout, split_compact_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::delegate_cloning_policy<Interface>, Layout>;
+
+    const auto ids_of = [](const vector& vec) {
+        std::vector<size_t> res;
+        for (const auto& elem : vec) {
+            res.push_back(elem.getId());
+        }
+        return res;
+    };
+
+    vector              v;
+    std::vector<size_t> ids;
+    v.reserve(2, 256);
+    const auto data = v.data();
+    for (auto i = 0; i < 9; ++i) {
+        v.push_back(Impl1(i));
+        ids.push_back(v.back().getId());
+    }
+    // only the index had to grow, the objects stayed where they were
+    REQUIRE(v.capacity() > v.size());
+    REQUIRE(data == v.data());
+    REQUIRE(ids == ids_of(v));
+
+    const auto capacity = v.capacity();
+    while (v.size() < capacity && data == v.data()) {
+        v.push_back(Impl2T<poly::delegate_cloning_policy<Interface>>());
+        ids.push_back(v.back().getId());
+    }
+    REQUIRE(data != v.data());
+    REQUIRE(capacity == v.capacity());
+    REQUIRE(ids == ids_of(v));
+
+    vector copy(v);
+    REQUIRE(ids_of(copy).size() == v.size());
+    v.shrink_to_fit();
+    REQUIRE(v.capacity() == v.size());
+    REQUIRE(ids == ids_of(v));
+}
+
+TYPE_P_TEST_CASE("copy assignment reuses the storage if it is large enough", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, poly::vector_layout<poly::compact_index>,
+    natural_pointer_layout, natural_compact_layout, split_pointer_layout, split_compact_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::delegate_cloning_policy<Interface>, Layout>;
+    using Impl2 = Impl2T<poly::delegate_cloning_policy<Interface>>;
+
+    vector              front;
+    std::vector<size_t> ids;
+    for (auto i = 0; i < 16; ++i) {
+        if (i % 3 == 1) {
+            front.push_back(Impl2());
+        } else {
+            front.push_back(Impl1(i));
+        }
+        ids.push_back(front.back().getId());
+    }
+    vector back;
+    back.reserve(32, 256, alignof(Impl2));
+    back.push_back(Impl1(1.0));
+    const auto data       = back.data();
+    const auto capacities = back.capacities();
+    for (auto i = 0; i < 3; ++i) {
+        back = front;
+        REQUIRE(back.data() == data);
+        REQUIRE(back.capacities() == capacities);
+        REQUIRE(back.max_align() == front.max_align());
+        REQUIRE(back.size() == ids.size());
+        for (size_t j = 0; j < ids.size(); ++j) {
+            REQUIRE(back[j].getId() == ids[j]);
+            REQUIRE(reinterpret_cast<uintptr_t>(&back[j]) % alignof(Interface) == 0);
+        }
+        REQUIRE(dynamic_cast<Impl2*>(&back[1]) != nullptr);
+        REQUIRE(reinterpret_cast<uintptr_t>(&back[1]) % alignof(Impl2) == 0);
+        front.pop_back();
+        ids.pop_back();
+    }
+
+    SECTION("failing copy leaves the target empty")
+    {
+        front[3].set_throw_on_copy_construction(true);
+        REQUIRE_THROWS(back = front);
+        REQUIRE(back.empty());
+        REQUIRE(back.data() == data);
+        back.push_back(Impl1(1.0));
+        REQUIRE(back.size() == 1);
+    }
+    SECTION("smaller storage is reallocated")
+    {
+        vector small;
+        small.push_back(Impl1(1.0));
+        small = front;
+        REQUIRE(small.size() == front.size());
+        REQUIRE(small.capacity() >= front.size());
+    }
+}
+
+TEST_CASE("storage accounting keeps the padded extent of every alignment class",
+    "[poly_vector_basic_tests]")
+{
+    poly::vector_impl::storage_accounting<true, true> s;
+    s.add(24, 8, true);
+    s.add(48, 16, false);
+    s.add(100, 512, true);
+    REQUIRE(s.top_align == 512);
+    REQUIRE(s.padded_extent(8) == 24 + 48 + 104);
+    REQUIRE(s.padded_extent(64) == 64 + 64 + 128);
+    REQUIRE(s.padded_extent(128) == 3 * 128);
+    // larger alignments are estimated from above
+    REQUIRE(s.padded_extent(1024) >= 3 * 1024);
+    REQUIRE(s.natural_extent_bound() == 172 + 7 + 15 + 511);
+
+    s.remove(100, 512, true);
+    REQUIRE(s.padded_extent(16) == 32 + 48);
+    REQUIRE(s.natural_extent_bound() == 72 + 7 + 15);
+    REQUIRE_FALSE(s.trivially_destructible());
+    s.remove(48, 16, false);
+    REQUIRE(s.trivially_destructible());
+    s.remove(24, 8, true);
+    REQUIRE(s.top_align == 0);
+    REQUIRE(s.padded_extent(64) == 0);
+
+    SECTION("basic accounting bounds the extent from the payload")
+    {
+        poly::vector_impl::storage_accounting<false, false> b;
+        REQUIRE(sizeof(b) == 3 * sizeof(size_t));
+        b.add(24, 8, true);
+        b.add(48, 16, true);
+        REQUIRE(b.padded_extent(16) == 72 + 2 * 15);
+        REQUIRE(b.natural_extent_bound() == 72 + 2 * 15);
+        // without the counts the destructors are assumed to be needed
+        REQUIRE_FALSE(b.trivially_destructible());
+        b.remove(24, 8, true);
+        b.remove(48, 16, true);
+        REQUIRE(b.trivially_destructible());
+        REQUIRE(b.natural_extent_bound() == 0);
+    }
+}
+
+TYPE_P_TEST_CASE("storage accounting follows random modifications", "[vector]", Layout,
+    poly::vector_layout<poly::pointer_index>, poly::vector_layout<poly::compact_index>,
+    natural_pointer_layout, natural_compact_layout, split_pointer_layout, split_compact_layout)
+{
+    using vector = poly::vector<Interface, std::allocator<Interface>,
+        poly::descriptor_cloning_policy<Interface>, Layout>;
+    using Impl2 = Impl2T<poly::descriptor_cloning_policy<Interface>>;
+
+    vector              v;
+    std::vector<size_t> ids;
+    std::srand(42);
+    for (auto i = 0; i < 512; ++i) {
+        const auto pos = ids.empty() ? 0 : static_cast<size_t>(std::rand()) % ids.size();
+        switch (std::rand() % 6) {
+        case 0:
+            v.push_back(Impl2());
+            ids.push_back(v.back().getId());
+            break;
+        case 1:
+            if (!ids.empty()) {
+                v.erase(v.begin() + pos);
+                ids.erase(ids.begin() + pos);
+            }
+            break;
+        case 2: {
+            Impl1 obj;
+            ids.insert(ids.begin() + pos, obj.getId());
+            v.insert(v.begin() + pos, std::move(obj));
+            break;
+        }
+        case 3:
+            if (i % 64 == 3) {
+                v.shrink_to_fit();
+            }
+            break;
+        default:
+            v.template emplace_back<RelocatableImpl>(i);
+            ids.push_back(v.back().getId());
+            break;
+        }
+    }
+    std::vector<size_t> res;
+    for (const auto& elem : v) {
+        res.push_back(elem.getId());
+    }
+    REQUIRE(ids == res);
+    v.clear();
+    REQUIRE(v.max_align() == alignof(Interface));
+}
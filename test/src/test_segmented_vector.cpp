@@ -0,0 +1,281 @@
+#include "catch_ext.hpp"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <map>
+#include <vector>
+
+#include "test_poly_vector.h"
+#include <poly/segmented_vector.h>
+
+namespace {
+using segmented_vector = poly::segmented_vector<Interface>;
+
+std::vector<size_t> ids_of(const segmented_vector& vec)
+{
+    std::vector<size_t> res;
+    for (const auto& elem : vec) {
+        res.push_back(elem.getId());
+    }
+    return res;
+}
+
+std::map<const void*, int>& owners()
+{
+    static std::map<const void*, int> o;
+    return o;
+}
+
+/// allocator that does not propagate and only compares equal to the allocators of the same tag,
+/// checking that storage is released by the allocator that allocated it
+template <class T> struct tagged_allocator {
+    using value_type                             = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap            = std::false_type;
+    using is_always_equal                        = std::false_type;
+
+    explicit tagged_allocator(int t) noexcept
+        : tag { t }
+    {
+    }
+    template <class U>
+    tagged_allocator(const tagged_allocator<U>& a) noexcept
+        : tag { a.tag }
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        const auto p = std::allocator<T>().allocate(n);
+        owners()[p]  = tag;
+        return p;
+    }
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if (!p) {
+            return;
+        }
+        CHECK(owners()[p] == tag);
+        owners().erase(p);
+        std::allocator<T>().deallocate(p, n);
+    }
+    template <class U> bool operator==(const tagged_allocator<U>& rhs) const noexcept
+    {
+        return tag == rhs.tag;
+    }
+    template <class U> bool operator!=(const tagged_allocator<U>& rhs) const noexcept
+    {
+        return tag != rhs.tag;
+    }
+
+    int tag;
+};
+} // namespace
+
+TEST_CASE("segmented vector keeps its objects in place while growing", "[segmented_vector]")
+{
+    segmented_vector              v;
+    std::vector<const Interface*> addresses;
+    std::vector<size_t>           ids;
+    for (auto i = 0; i < 256; ++i) {
+        if (i % 5 == 2) {
+            v.push_back(Impl2());
+        } else {
+            v.emplace_back<Impl1>(i);
+        }
+        addresses.push_back(&v.back());
+        ids.push_back(v.back().getId());
+        REQUIRE(reinterpret_cast<uintptr_t>(&v.back()) % alignof(Interface) == 0);
+    }
+    REQUIRE(v.size() == 256);
+    REQUIRE(v.segments() > 1);
+    REQUIRE(ids == ids_of(v));
+    for (size_t i = 0; i < v.size(); ++i) {
+        REQUIRE(&v[i] == addresses[i]);
+    }
+    REQUIRE(dynamic_cast<Impl2*>(&v.at(2)) != nullptr);
+    REQUIRE(reinterpret_cast<uintptr_t>(&v[2]) % alignof(Impl2) == 0);
+    REQUIRE_THROWS_AS(v.at(256), std::out_of_range);
+
+    SECTION("segments grow geometrically")
+    {
+        segmented_vector w;
+        for (auto i = 0; i < 4096; ++i) {
+            w.emplace_back<Impl1>(i);
+        }
+        REQUIRE(w.segments() < 16);
+    }
+    SECTION("copies are stored in a single segment")
+    {
+        segmented_vector copy(v);
+        REQUIRE(copy.size() == v.size());
+        REQUIRE(copy.segments() == 1);
+        REQUIRE(dynamic_cast<Impl2*>(&copy[2]) != nullptr);
+        segmented_vector assigned;
+        assigned.push_back(Impl1(1.0));
+        assigned = copy;
+        REQUIRE(assigned.size() == v.size());
+    }
+    SECTION("failing copy leaves nothing behind")
+    {
+        v.back().set_throw_on_copy_construction(true);
+        REQUIRE_THROWS(segmented_vector(v));
+    }
+    SECTION("moving keeps the objects where they are")
+    {
+        segmented_vector moved(std::move(v));
+        REQUIRE(v.empty());
+        REQUIRE(&moved[0] == addresses[0]);
+        v = std::move(moved);
+        REQUIRE(&v[255] == addresses[255]);
+        REQUIRE(moved.empty());
+    }
+    SECTION("erase keeps the remaining objects in place")
+    {
+        v.erase(v.begin() + 10, v.begin() + 20);
+        ids.erase(ids.begin() + 10, ids.begin() + 20);
+        addresses.erase(addresses.begin() + 10, addresses.begin() + 20);
+        v.erase(v.begin());
+        ids.erase(ids.begin());
+        addresses.erase(addresses.begin());
+        REQUIRE(ids == ids_of(v));
+        for (size_t i = 0; i < v.size(); ++i) {
+            REQUIRE(&v[i] == addresses[i]);
+        }
+    }
+    SECTION("the storage of the last object is reused")
+    {
+        const auto last = addresses.back();
+        v.pop_back();
+        v.emplace_back<Impl1>(1.0);
+        REQUIRE(&v.back() == last);
+    }
+    SECTION("clear keeps the last segment only")
+    {
+        v.clear();
+        REQUIRE(v.empty());
+        REQUIRE(v.segments() == 1);
+        v.emplace_back<Impl1>(1.0);
+        REQUIRE(v.size() == 1);
+    }
+}
+
+TEST_CASE("segmented vector reserve grows the index only", "[segmented_vector]")
+{
+    segmented_vector v;
+    v.reserve(64);
+    REQUIRE(v.capacity() == 64);
+    REQUIRE(v.segments() == 0);
+    v.push_back(Impl1(1.0));
+    REQUIRE(v.capacity() == 64);
+    REQUIRE(v.segments() == 1);
+}
+
+TEST_CASE("segmented vector assignment keeps the allocator that does not propagate",
+    "[segmented_vector]")
+{
+    using vector = poly::segmented_vector<Interface, tagged_allocator<Interface>>;
+    using alloc  = vector::allocator_type;
+
+    vector v(alloc(1));
+    for (auto i = 0; i < 64; ++i) {
+        v.emplace_back<Impl1>(i);
+    }
+    vector w(alloc(2));
+    w.push_back(Impl2());
+    const auto ids = std::vector<size_t> { v[0].getId(), v[63].getId() };
+
+    SECTION("copy assignment")
+    {
+        w = v;
+        REQUIRE(w.get_allocator() == alloc(2));
+        REQUIRE(w.size() == 64);
+        REQUIRE(w[63].getId() == ids[1]);
+        REQUIRE(v.size() == 64);
+    }
+    SECTION("move assignment clones between different allocators")
+    {
+        w = std::move(v);
+        REQUIRE(w.get_allocator() == alloc(2));
+        REQUIRE(w.size() == 64);
+        REQUIRE(w[0].getId() == ids[0]);
+        REQUIRE(w[63].getId() == ids[1]);
+    }
+    SECTION("move assignment takes the storage of an equal allocator")
+    {
+        vector     u(alloc(1));
+        const auto first = &v[0];
+        u                = std::move(v);
+        REQUIRE(&u[0] == first);
+        REQUIRE(v.empty());
+    }
+    v.clear();
+    w.clear();
+    REQUIRE_FALSE((std::is_nothrow_move_assignable<vector>::value));
+    REQUIRE((std::is_nothrow_move_assignable<segmented_vector>::value));
+}
+
+using _1 = std::true_type;
+using _0 = std::false_type;
+
+using D0  = custom::AllocatorDescriptor<_0, _0, _0, _0, _0>;
+using D4  = custom::AllocatorDescriptor<_0, _0, _1, _0, _0>;
+using D10 = custom::AllocatorDescriptor<_0, _1, _0, _1, _0>;
+using D3  = custom::AllocatorDescriptor<_0, _0, _0, _1, _1>;
+using D16 = custom::AllocatorDescriptor<_1, _0, _0, _0, _0>;
+using D31 = custom::AllocatorDescriptor<_1, _1, _1, _1, _1>;
+
+TYPE_P_TEST_CASE("segmented vector with custom allocators", "[segmented_vector]", AllocD, D0, D3,
+    D4, D10, D16, D31)
+{
+    using vector = poly::segmented_vector<Interface, custom::Allocator<Interface, AllocD>>;
+    vector v;
+    v.push_back(Impl1(3.14));
+    v.push_back(Impl2());
+    v.push_back(Impl1(3.14));
+    const auto check = [](const vector& vec) {
+        REQUIRE(vec.size() == 3);
+        REQUIRE_NOTHROW(dynamic_cast<const Impl1&>(vec[0]));
+        REQUIRE_NOTHROW(dynamic_cast<const Impl2&>(vec[1]));
+        REQUIRE_NOTHROW(dynamic_cast<const Impl1&>(vec[2]));
+    };
+
+    SECTION("when vector is copy constructed")
+    {
+        vector copy = v;
+        check(copy);
+        check(v);
+    }
+    SECTION("when vector is move constructed")
+    {
+        vector moved = std::move(v);
+        check(moved);
+    }
+    SECTION("when vector is copy assigned")
+    {
+        vector w;
+        w.push_back(Impl2());
+        w = v;
+        check(w);
+        REQUIRE(w[0] == v[0]);
+        w = vector();
+        REQUIRE(w.empty());
+    }
+    SECTION("when vector is move assigned")
+    {
+        vector w;
+        w.push_back(Impl2());
+        w = std::move(v);
+        check(w);
+        vector empty;
+        w = std::move(empty);
+        REQUIRE(w.empty());
+    }
+    SECTION("when vectors are swapped")
+    {
+        vector w;
+        w.swap(v);
+        check(w);
+        REQUIRE(v.empty());
+    }
+}